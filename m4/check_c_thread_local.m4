@@ -0,0 +1,29 @@
+# check_c_thread_local.m4 - check if C compiler supports __thread storage class
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+
+# ACX_CHECK_C_THREAD_LOCAL([HEADER])
+# -------------------------------------------
+AC_DEFUN([ACX_CHECK_C_THREAD_LOCAL],
+    [m4_define([myname], [HAVE___THREAD])
+        AH_TEMPLATE(AS_TR_CPP(myname),
+            [Define to 1 if compiler supports `__thread' storage class.])
+        AS_VAR_PUSHDEF([acx_var], [acx_cv_c_thread_local])
+        AC_CACHE_CHECK([whether compiler supports __thread storage class],
+            acx_var,
+            [AC_LINK_IFELSE([AC_LANG_PROGRAM([
+$1
+static __thread int foo;
+                    ], [
+foo = 1;
+                    ])],
+            [AS_VAR_SET(acx_var, [yes])], [AS_VAR_SET(acx_var, [no])])])
+        AS_VAR_IF(acx_var, [yes],
+            [AC_DEFINE_UNQUOTED(AS_TR_CPP(myname), [1])
+                AS_VAR_SET(acx_var, [yes])])
+        AS_VAR_POPDEF([acx_var])
+        m4_undefine([myname])
+])
@@ -0,0 +1,105 @@
+#!@PERL@
+
+# fakechroot-trace
+#
+# Decoder for the binary trace written by libfakechroot when the
+# FAKECHROOT_TRACE environment variable is set.
+#
+# LGPL
+
+use strict;
+
+my $Usage = "Usage: fakechroot-trace [-s] FILE...\n" .
+            "       fakechroot-trace -H PATH...\n";
+
+my $Summary = 0;
+
+# FNV-1a hash of the path as recorded in the events
+sub path_hash {
+    my ($path) = @_;
+    my $h = 2166136261;
+    foreach my $c (unpack 'C*', $path) {
+        $h ^= $c;
+        $h = ($h * 16777619) % 4294967296;
+    }
+    return $h;
+}
+
+sub decode {
+    my ($file) = @_;
+
+    open my $fh, '<', $file or die "fakechroot-trace: $file: $!\n";
+    binmode $fh;
+    local $/;
+    my $data = <$fh>;
+    close $fh;
+
+    my ($magic, $version, $event_size, $rings, $ring_events, $names_max,
+        $names_used, $dropped, $pid, $start) = unpack 'a8 L8 Q', $data;
+
+    die "fakechroot-trace: $file: not a trace file\n" unless $magic eq "FCTRACE\n";
+    die "fakechroot-trace: $file: unsupported version $version\n" unless $version == 1;
+
+    my %Names;
+    $names_used = $names_max if $names_used > $names_max;
+    for (my $i = 0; $i < $names_used; $i++) {
+        my ($id, $name) = unpack 'L Z60', substr $data, 4096 + $i * 64, 64;
+        next unless $id;
+        $name =~ s/^__(.*)_alias$/$1/;
+        $Names{$id} = $name;
+    }
+
+    my @Events;
+    my $ring_size = 64 + $ring_events * $event_size;
+    my $rings_offset = 4096 + $names_max * 64;
+
+    for (my $r = 0; $r < $rings; $r++) {
+        my $offset = $rings_offset + $r * $ring_size;
+        last if $offset + $ring_size > length $data;
+        my ($owner, undef, $head) = unpack 'L L Q', substr $data, $offset, 16;
+        my $n = $head < $ring_events ? $head : $ring_events;
+        for (my $i = $head - $n; $i < $head; $i++) {
+            my $ev = substr $data, $offset + 64 + ($i % $ring_events) * $event_size, $event_size;
+            my ($time, $tid, $id, $in, $out, $flags) = unpack 'Q L5', $ev;
+            next unless $time;
+            push @Events, [ $time, $tid, $id, $in, $out, $flags ];
+        }
+    }
+
+    if ($Summary) {
+        my (%Count, %Translated);
+        foreach my $ev (@Events) {
+            $Count{$ev->[2]}++;
+            $Translated{$ev->[2]}++ if $ev->[5] & 1;
+        }
+        printf "# %s: pid %d, %d events, %d threads without a ring\n", $file, $pid, scalar @Events, $dropped;
+        foreach my $id (sort { $Count{$b} <=> $Count{$a} } keys %Count) {
+            printf "%-24s %10d %10d\n", $Names{$id} || sprintf('%08x', $id), $Count{$id}, $Translated{$id} || 0;
+        }
+        return;
+    }
+
+    printf "# %s: pid %d\n", $file, $pid;
+    foreach my $ev (sort { $a->[0] <=> $b->[0] } @Events) {
+        my ($time, $tid, $id, $in, $out, $flags) = @$ev;
+        printf "%14.6f %7d %-24s %08x %08x %s\n",
+            ($time - $start) / 1e9, $tid, $Names{$id} || sprintf('%08x', $id), $in, $out,
+            $flags & 1 ? 'translated' : $flags & 2 ? 'unchanged' : 'excluded';
+    }
+}
+
+if (@ARGV && $ARGV[0] eq '-H') {
+    shift @ARGV;
+    die $Usage unless @ARGV;
+    printf "%08x %s\n", path_hash($_), $_ foreach @ARGV;
+    exit 0;
+}
+
+if (@ARGV && $ARGV[0] eq '-s') {
+    shift @ARGV;
+    $Summary = 1;
+}
+
+die $Usage unless @ARGV;
+
+decode($_) foreach @ARGV;
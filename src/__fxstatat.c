@@ -30,14 +30,24 @@
 #include <stdlib.h>
 
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(__fxstatat, int, (int ver, int dirfd, const char * pathname, struct stat * buf, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("__fxstatat(%d, %d, \"%s\", &buf, %d)", ver, dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
+#ifdef HAVE_RAW_SYSCALLS
+    if (ver == _STAT_VER) {
+        if ((relpath = fakechroot_base_path(pathname)) != NULL)
+            return rawcall(fstatat)(fakechroot_base_fd, relpath, buf, flags);
+        return rawcall(fstatat)(dirfd, pathname, buf, flags);
+    }
+#endif
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(__fxstatat)(ver, fakechroot_base_fd, relpath, buf, flags);
     return nextcall(__fxstatat)(ver, dirfd, pathname, buf, flags);
 }
 
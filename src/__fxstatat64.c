@@ -31,14 +31,24 @@
 #include <stdlib.h>
 
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(__fxstatat64, int, (int ver, int dirfd, const char * pathname, struct stat64 * buf, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("__fxstatat64(%d, %d, \"%s\", &buf, %d)", ver, dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
+#ifdef HAVE_RAW_SYSCALLS
+    if (ver == _STAT_VER) {
+        if ((relpath = fakechroot_base_path(pathname)) != NULL)
+            return rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, flags);
+        return rawcall(fstatat64)(dirfd, pathname, buf, flags);
+    }
+#endif
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(__fxstatat64)(ver, fakechroot_base_fd, relpath, buf, flags);
     return nextcall(__fxstatat64)(ver, dirfd, pathname, buf, flags);
 }
 
@@ -31,27 +31,43 @@
 #include <fcntl.h>
 
 #include "libfakechroot.h"
-#include "readlink.h"
+#include "__fxstatat.h"
+#include "symlink_cache.h"
+#include "rawcall.h"
 
 
 wrapper(__lxstat, int, (int ver, const char * filename, struct stat * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
 
-    char tmp[FAKECHROOT_PATH_MAX];
+    struct symlink_cache_key key;
     int retval;
-    READLINK_TYPE_RETURN linksize;
-    const char* orig_filename;
+    ssize_t linksize;
 
     debug("__lxstat(%d, \"%s\", &buf)", ver, filename);
-    orig_filename = filename;
     expand_chroot_path(filename);
-    retval = nextcall(__lxstat)(ver, filename, buf);
+#ifdef HAVE_RAW_SYSCALLS
+    if (ver != _STAT_VER)
+        retval = nextcall(__lxstat)(ver, filename, buf);
+    else if ((relpath = fakechroot_base_path(filename)) != NULL)
+        retval = rawcall(fstatat)(fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+        retval = rawcall(fstatat)(AT_FDCWD, filename, buf, AT_SYMLINK_NOFOLLOW);
+#else
+#ifdef HAVE___FXSTATAT
+    if ((relpath = fakechroot_base_path(filename)) != NULL)
+        retval = nextcall(__fxstatat)(ver, fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+#endif
+        retval = nextcall(__lxstat)(ver, filename, buf);
+#endif
     /* deal with http://bugs.debian.org/561991 */
-    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK)
-        if ((linksize = readlink(orig_filename, tmp, sizeof(tmp)-1)) != -1)
+    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK) {
+        symlink_cache_key_init(&key, buf);
+        if ((linksize = symlink_cache_size(fakechroot_path, filename, &key)) != -1)
             buf->st_size = linksize;
+    }
 
     return retval;
 }
@@ -22,51 +22,68 @@
 
 #ifdef HAVE___LXSTAT64
 
+#define _ATFILE_SOURCE
 #define _LARGEFILE64_SOURCE
 #define _XOPEN_SOURCE 500
+#define _DEFAULT_SOURCE
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 
 #include "libfakechroot.h"
-#include "readlink.h"
-
-
-LOCAL int __lxstat64_rel(int, const char *, struct stat64 *);
+#include "__fxstatat64.h"
+#include "__lxstat64.h"
+#include "symlink_cache.h"
+#include "rawcall.h"
 
 
 wrapper(__lxstat64, int, (int ver, const char * filename, struct stat64 * buf))
 {
+    fakechroot_path_decl();
+    fakechroot_buf_decl(abs_filename);
+
     debug("__lxstat64(%d, \"%s\", &buf)", ver, filename);
 
     if (filename && !fakechroot_localdir(filename)) {
-        char abs_filename[FAKECHROOT_PATH_MAX];
         rel2abs(filename, abs_filename);
         filename = abs_filename;
     }
+    expand_chroot_rel_path(filename);
 
-    return __lxstat64_rel(ver, filename, buf);
+    return __lxstat64_translated(fakechroot_path, ver, filename, buf);
 }
 
 
-/* Prevent looping with realpath() */
-LOCAL int __lxstat64_rel(int ver, const char * filename, struct stat64 * buf)
+/* The path is already translated, see readlink_translated() */
+LOCAL int __lxstat64_translated(struct fakechroot_path * fakechroot_path, int ver, const char * filename, struct stat64 * buf)
 {
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    const char *relpath;
 
-    char tmp[FAKECHROOT_PATH_MAX];
+    struct symlink_cache_key key;
     int retval;
-    READLINK_TYPE_RETURN linksize;
-    const char *orig_filename;
-
-    debug("__lxstat64_rel(%d, \"%s\", &buf)", ver, filename);
-    orig_filename = filename;
-    expand_chroot_rel_path(filename);
-    retval = nextcall(__lxstat64)(ver, filename, buf);
+    ssize_t linksize;
+
+#ifdef HAVE_RAW_SYSCALLS
+    if (ver != _STAT_VER)
+        retval = nextcall(__lxstat64)(ver, filename, buf);
+    else if ((relpath = fakechroot_base_path(filename)) != NULL)
+        retval = rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+        retval = rawcall(fstatat64)(AT_FDCWD, filename, buf, AT_SYMLINK_NOFOLLOW);
+#else
+#ifdef HAVE___FXSTATAT64
+    if ((relpath = fakechroot_base_path(filename)) != NULL)
+        retval = nextcall(__fxstatat64)(ver, fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+#endif
+        retval = nextcall(__lxstat64)(ver, filename, buf);
+#endif
     /* deal with http://bugs.debian.org/561991 */
-    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK)
-        if ((linksize = readlink(orig_filename, tmp, sizeof(tmp)-1)) != -1)
+    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK) {
+        symlink_cache_key_init(&key, buf);
+        if ((linksize = symlink_cache_size(fakechroot_path, filename, &key)) != -1)
             buf->st_size = linksize;
+    }
 
     return retval;
 }
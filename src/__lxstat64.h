@@ -37,7 +37,7 @@
 
 wrapper_proto(__lxstat64, int, (int, const char *, struct stat64 *));
 
-int __lxstat64_rel(int, const char *, struct stat64 *);
+int __lxstat64_translated(struct fakechroot_path *, int, const char *, struct stat64 *);
 
 #endif
 
@@ -25,13 +25,17 @@
 #include <stdarg.h>
 #include <fcntl.h>
 #include "libfakechroot.h"
+#include "openat.h"
+#include "fd_path.h"
+#include "rawcall.h"
 
 
 /* Internal libc function */
 wrapper(__open, int, (const char * pathname, int flags, ...))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
 
     int mode = 0;
 
@@ -46,7 +50,21 @@ wrapper(__open, int, (const char * pathname, int flags, ...))
         va_end(arg);
     }
 
-    return nextcall(__open)(pathname, flags, mode);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = rawcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = rawcall(openat)(AT_FDCWD, pathname, flags, mode);
+#else
+#ifdef HAVE_OPENAT
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+#endif
+        fd = nextcall(__open)(pathname, flags, mode);
+#endif
+    fd_path_register(fd, fakechroot_path, AT_FDCWD, pathname);
+    return fd;
 }
 
 #else
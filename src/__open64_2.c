@@ -23,17 +23,28 @@
 #ifdef HAVE___OPEN64_2
 
 #define _LARGEFILE64_SOURCE
+#include <fcntl.h>
 #include "libfakechroot.h"
+#include "openat64.h"
+#include "fd_path.h"
 
 
 /* Internal libc function */
 wrapper(__open64_2, int, (const char * pathname, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
     debug("__open64_2(\"%s\", %d)", pathname, flags);
     expand_chroot_path(pathname);
-    return nextcall(__open64_2)(pathname, flags);
+#ifdef HAVE_OPENAT64
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat64)(fakechroot_base_fd, relpath, flags);
+    else
+#endif
+        fd = nextcall(__open64_2)(pathname, flags);
+    fd_path_register(fd, fakechroot_path, AT_FDCWD, pathname);
+    return fd;
 }
 
 #else
@@ -22,17 +22,28 @@
 
 #ifdef HAVE___OPEN_2
 
+#include <fcntl.h>
 #include "libfakechroot.h"
+#include "openat.h"
+#include "fd_path.h"
 
 
 /* Internal libc function */
 wrapper(__open_2, int, (const char * pathname, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
     debug("__open_2(\"%s\", %d)", pathname, flags);
     expand_chroot_path(pathname);
-    return nextcall(__open_2)(pathname, flags);
+#ifdef HAVE_OPENAT
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat)(fakechroot_base_fd, relpath, flags);
+    else
+#endif
+        fd = nextcall(__open_2)(pathname, flags);
+    fd_path_register(fd, fakechroot_path, AT_FDCWD, pathname);
+    return fd;
 }
 
 #else
@@ -23,17 +23,25 @@
 #ifdef HAVE___OPENAT64_2
 
 #define _LARGEFILE64_SOURCE
+#include <fcntl.h>
 #include "libfakechroot.h"
+#include "fd_path.h"
 
 
 /* Internal libc function */
 wrapper(__openat64_2, int, (int dirfd, const char * pathname, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
     debug("__openat64_2(%d, \"%s\", %d)", dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
-    return nextcall(__openat64_2)(dirfd, pathname, flags);
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(__openat64_2)(fakechroot_base_fd, relpath, flags);
+    else
+        fd = nextcall(__openat64_2)(dirfd, pathname, flags);
+    fd_path_register(fd, fakechroot_path, dirfd, pathname);
+    return fd;
 }
 
 #else
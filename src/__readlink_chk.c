@@ -30,13 +30,10 @@
 
 wrapper(__readlink_chk, ssize_t, (const char * path, char * buf, size_t bufsiz, size_t buflen))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
     int linksize;
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr;
-
-    const char *fakechroot_base = getenv("FAKECHROOT_BASE");
+    fakechroot_buf_decl(tmp);
 
     debug("__readlink_chk(\"%s\", &buf, %zd, %zd)", path, bufsiz, buflen);
     expand_chroot_path(path);
@@ -49,33 +46,11 @@ wrapper(__readlink_chk, ssize_t, (const char * path, char * buf, size_t bufsiz,
     }
     tmp[linksize] = '\0';
 
-    if (fakechroot_base != NULL) {
-        tmpptr = strstr(tmp, fakechroot_base);
-        if (tmpptr != tmp) {
-            tmpptr = tmp;
-        }
-        else if (tmp[strlen(fakechroot_base)] == '\0') {
-            tmpptr = "/";
-            linksize = strlen(tmpptr);
-        }
-        else if (tmp[strlen(fakechroot_base)] == '/') {
-            tmpptr = tmp + strlen(fakechroot_base);
-            linksize -= strlen(fakechroot_base);
-        }
-        else {
-            tmpptr = tmp;
-        }
-        if (strlen(tmpptr) > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmpptr, linksize);
-    }
-    else {
-        if (linksize > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmp, linksize);
+    linksize = narrow_chroot_path(tmp);
+    if (linksize > bufsiz) {
+        linksize = bufsiz;
     }
+    memcpy(buf, tmp, linksize);
     return linksize;
 }
 
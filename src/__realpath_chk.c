@@ -28,6 +28,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "libfakechroot.h"
+#include "realpath_walk.h"
 
 
 #ifdef HAVE___CHK_FAIL
@@ -42,11 +43,13 @@ __attribute__((__noreturn__)) void __chk_fail (void)
 
 wrapper(__realpath_chk, char *, (const char * path, char * resolved, size_t resolvedlen))
 {
+    stats_frame_decl();
+
     debug("__realpath_chk(\"%s\", &buf, %zd)", path, resolvedlen);
     if (resolvedlen < FAKECHROOT_PATH_MAX)
         __chk_fail();
 
-    return realpath(path, resolved);
+    return realpath_walk(path, resolved);
 }
 
 #else
@@ -28,8 +28,7 @@
 
 wrapper(__statfs, int, (const char * path, struct statfs * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("__statfs(\"%s\", &buf)", path);
     expand_chroot_path(path);
     return nextcall(__statfs)(path, buf);
@@ -30,8 +30,7 @@
 
 wrapper(__xmknod, int, (int ver, const char * path, mode_t mode, dev_t * dev))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("__xmknod(%d, \"%s\", 0%o, &dev)", ver, path, mode);
     expand_chroot_path(path);
     return nextcall(__xmknod)(ver, path, mode, dev);
@@ -30,14 +30,27 @@
 #include <stdlib.h>
 
 #include "libfakechroot.h"
+#include "__fxstatat64.h"
+#include "rawcall.h"
 
 
 wrapper(__xstat64, int, (int ver, const char * filename, struct stat64 * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("__xstat64(%d, \"%s\", &buf)", ver, filename);
     expand_chroot_path(filename);
+#ifdef HAVE_RAW_SYSCALLS
+    if (ver == _STAT_VER) {
+        if ((relpath = fakechroot_base_path(filename)) != NULL)
+            return rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, 0);
+        return rawcall(fstatat64)(AT_FDCWD, filename, buf, 0);
+    }
+#endif
+#ifdef HAVE___FXSTATAT64
+    if ((relpath = fakechroot_base_path(filename)) != NULL)
+        return nextcall(__fxstatat64)(ver, fakechroot_base_fd, relpath, buf, 0);
+#endif
     return nextcall(__xstat64)(ver, filename, buf);
 }
 
@@ -36,8 +36,7 @@ static int _xftw_fn_wrapper (const char * file, const struct stat * sb, int flag
 
 wrapper(_xftw, int, (int mode, const char * dir, int (* fn)(const char * file, const struct stat * sb, int flag), int nopenfd))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("_xftw(%d, \"%s\", &fn, %d)", mode, dir, nopenfd);
     expand_chroot_path(dir);
     _xftw_fn_saved = fn;
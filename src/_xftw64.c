@@ -37,6 +37,7 @@ static int _xftw64_fn_wrapper (const char * file, const struct stat * sb, int fl
 
 wrapper(_xftw64, int, (int mode, const char * dir, int (* fn)(const char * file, const struct stat64 * sb, int flag), int nopenfd))
 {
+    fakechroot_path_decl();
     debug("_xftw64(%d, \"%s\", &fn, %d)", mode, dir, nopenfd);
     expand_chroot_path(dir);
     _xftw64_fn_saved = fn;
@@ -21,13 +21,22 @@
 #include <config.h>
 
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(access, int, (const char * pathname, int mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+#ifdef HAVE_RAW_SYSCALLS
+    const char *relpath;
+#endif
     debug("access(\"%s\", %d)", pathname, mode);
     expand_chroot_path(pathname);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return rawcall(faccessat)(fakechroot_base_fd, relpath, mode, 0);
+    return rawcall(faccessat)(AT_FDCWD, pathname, mode, 0);
+#else
     return nextcall(access)(pathname, mode);
+#endif
 }
@@ -25,8 +25,7 @@
 
 wrapper(acct, int, (const char * filename))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("acct(\"%s\")", filename);
     expand_chroot_path(filename);
     return nextcall(acct)(filename);
@@ -32,4 +32,8 @@
 /* Hardcoded --argv0 option for login shell detection */
 #define ANDROID_ARGV0_OPT "--argv0"
 
+/* Nix store inside the base; registered store paths have this mtime */
+#define ANDROID_NIX_STORE "/nix/store"
+#define ANDROID_NIX_STORE_MTIME 1
+
 #endif /* __ANDROID_CONFIG_H */
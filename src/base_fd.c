@@ -0,0 +1,87 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libfakechroot.h"
+#include "base_fd.h"
+#include "open.h"
+
+
+/*
+ * Base directory descriptor.
+ *
+ * ANDROID_BASE is a deep prefix and the kernel walks all of its components
+ * again for every translated path.  If FAKECHROOT_BASE_FD is set (and it is
+ * not "0") the base is opened once as an O_PATH directory and the wrappers
+ * which have an *at() counterpart pass the remainder of the translated path
+ * relative to this descriptor.
+ *
+ * The descriptor is moved above BASE_FD_MIN so it does not take the low
+ * numbers which programs expect to get from open(), and it is close-on-exec
+ * because the constructor of the new image opens its own one.
+ */
+
+#define BASE_FD_MIN 512
+
+LOCAL int fakechroot_base_fd = -1;
+
+
+/* Open a new descriptor for the base; the previous one is not closed */
+LOCAL int base_fd_open(void)
+{
+#ifdef O_PATH
+    int fd, highfd;
+
+    if ((fd = nextcall(open)(ANDROID_BASE, O_PATH | O_DIRECTORY | O_CLOEXEC)) == -1) {
+        debug("base_fd_open(): cannot open \"%s\"", ANDROID_BASE);
+        fakechroot_base_fd = -1;
+        return -1;
+    }
+    if ((highfd = fcntl(fd, F_DUPFD_CLOEXEC, BASE_FD_MIN)) != -1) {
+        close(fd);
+        fd = highfd;
+    }
+
+    debug("base_fd_open(): %d", fd);
+    fakechroot_base_fd = fd;
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+
+/* Open the descriptor if FAKECHROOT_BASE_FD is enabled */
+LOCAL void base_fd_init(void)
+{
+    const char *mode = getenv("FAKECHROOT_BASE_FD");
+
+    if (mode == NULL || *mode == '\0' || strcmp(mode, "0") == 0)
+        return;
+
+    base_fd_open();
+}
@@ -22,23 +22,17 @@
 
 #ifdef HAVE_CANONICALIZE_FILE_NAME
 
-#include <stdlib.h>
+#include <stddef.h>
 #include "libfakechroot.h"
-
-#ifdef HAVE___REALPATH_CHK
-# include "__realpath_chk.h"
-#endif
+#include "realpath_walk.h"
 
 
 wrapper(canonicalize_file_name, char *, (const char * name))
 {
-    char *resolved = malloc(FAKECHROOT_PATH_MAX * 2);
+    stats_frame_decl();
+
     debug("canonicalize_file_name(\"%s\")", name);
-#ifdef HAVE___REALPATH_CHK
-    return __realpath_chk(name, resolved, FAKECHROOT_PATH_MAX * 2);
-#else
-    return realpath(name, resolved);
-#endif
+    return realpath_walk(name, NULL);
 }
 
 #else
@@ -22,31 +22,30 @@
 
 #include <string.h>
 #include "libfakechroot.h"
-#include "getcwd_real.h"
+#include "getcwd_cached.h"
 
 
 wrapper(chdir, int, (const char * path))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
-    char cwd[FAKECHROOT_PATH_MAX];
-
-    const char *fakechroot_base = getenv("FAKECHROOT_BASE");
+    const char *cwd;
+    int status;
 
     debug("chdir(\"%s\")", path);
 
-    if (getcwd_real(cwd, FAKECHROOT_PATH_MAX) == NULL) {
+    if ((cwd = getcwd_cached_host(NULL)) == NULL) {
         return -1;
     }
-    if (fakechroot_base != NULL) {
-        if (strstr(cwd, fakechroot_base) == cwd) {
-            expand_chroot_path(path);
-        }
-        else {
-            expand_chroot_rel_path(path);
-        }
+    if (fakechroot_in_base(cwd)) {
+        expand_chroot_path(path);
+    }
+    else {
+        expand_chroot_rel_path(path);
     }
 
-    return nextcall(chdir)(path);
+    if ((status = nextcall(chdir)(path)) == 0) {
+        getcwd_cached_invalidate();
+    }
+    return status;
 }
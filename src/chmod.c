@@ -27,8 +27,7 @@
 
 wrapper(chmod, int, (const char * path, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("chmod(\"%s\", 0%o)", path, mode);
     expand_chroot_path(path);
     return nextcall(chmod)(path, mode);
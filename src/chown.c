@@ -27,8 +27,7 @@
 
 wrapper(chown, int, (const char * path, uid_t owner, gid_t group))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("chown(\"%s\", %d, %d)", path, owner, group);
     expand_chroot_path(path);
     return nextcall(chown)(path, owner, group);
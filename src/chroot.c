@@ -42,22 +42,20 @@
 # define STAT(path, sb) nextcall(stat)(path, sb)
 #endif
 
-#include "getcwd_real.h"
+#include "getcwd_cached.h"
 
 wrapper(chroot, int, (const char * path))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
     char *ld_library_path, *separator, *new_ld_library_path;
     int status;
     size_t len;
-    char cwd[FAKECHROOT_PATH_MAX - 1];
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr = tmp;
+    const char *cwd;
+    fakechroot_buf_decl(tmp);
+    char *tmpptr = tmp;
     struct STAT_T sb;
 
-    const char *fakechroot_base = getenv("FAKECHROOT_BASE");
-
     debug("chroot(\"%s\")", path);
 
     if (!path) {
@@ -70,12 +68,12 @@ wrapper(chroot, int, (const char * path))
         return -1;
     }
 
-    if (getcwd_real(cwd, FAKECHROOT_PATH_MAX - 1) == NULL) {
+    if ((cwd = getcwd_cached_host(NULL)) == NULL) {
         __set_errno(EIO);
         return -1;
     }
 
-    if (fakechroot_base != NULL && strstr(cwd, fakechroot_base) == cwd) {
+    if (fakechroot_in_base(cwd)) {
         expand_chroot_path(path);
         strlcpy(tmp, path, FAKECHROOT_PATH_MAX);
         dedotdot(tmpptr);
@@ -118,6 +116,8 @@ wrapper(chroot, int, (const char * path))
         return -1;
     }
 
+    getcwd_cached_invalidate();
+
     ld_library_path = getenv("LD_LIBRARY_PATH");
 
     if (ld_library_path != NULL && strlen(ld_library_path) > 0) {
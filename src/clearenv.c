@@ -36,6 +36,7 @@ extern char **environ;
 #endif
 
 #include "libfakechroot.h"
+#include "preserve_env.h"
 
 extern int __clearenv(void);
 
@@ -43,23 +44,24 @@ extern int __clearenv(void);
 wrapper(clearenv, int, (void))
 {
     int j, n;
-    char *key, *env;
+    const char **values;
     char **tmpkey, **tmpenv;
+    unsigned int found;
 
     debug("clearenv()");
 
     /* Preserve old environment variables */
     tmpkey = alloca( (preserve_env_list_count + 1) * sizeof (char *) );
     tmpenv = alloca( (preserve_env_list_count + 1) * sizeof (char *) );
+    values = alloca( preserve_env_list_count * sizeof (const char *) );
+
+    found = preserve_env_scan(environ, values);
 
     for (j = 0, n = 0; j < preserve_env_list_count; j++) {
-        key = preserve_env_list[j];
-        env = getenv(key);
-        if (env != NULL) {
-            tmpkey[n] = alloca(strlen(key) + 1);
-            tmpenv[n] = alloca(strlen(env) + 1);
-            strcpy(tmpkey[n], key);
-            strcpy(tmpenv[n], env);
+        if (found & (1U << j)) {
+            tmpkey[n] = preserve_env_list[j];
+            tmpenv[n] = alloca(strlen(values[j]) + 1);
+            strcpy(tmpenv[n], values[j]);
             n++;
         }
     }
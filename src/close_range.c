@@ -0,0 +1,62 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#ifdef HAVE_CLOSE_RANGE
+
+#define _GNU_SOURCE
+#include <unistd.h>
+#include "libfakechroot.h"
+#include "fd_path.h"
+
+
+wrapper(close_range, int, (unsigned int first, unsigned int last, int flags))
+{
+    unsigned int base = fakechroot_base_fd;
+    int status = 0;
+
+    debug("close_range(%u, %u, %d)", first, last, flags);
+
+    /*
+     * The descriptors only marked close-on-exec stay open, and the base
+     * descriptor is already close-on-exec.  Otherwise the range is split
+     * around the base descriptor, so the other threads never see it closed.
+     */
+    if (flags & CLOSE_RANGE_CLOEXEC)
+        return nextcall(close_range)(first, last, flags);
+
+    if (fakechroot_base_fd != -1 && base >= first && base <= last) {
+        if (base > first)
+            status = nextcall(close_range)(first, base - 1, flags);
+        if (status == 0 && base < last)
+            status = nextcall(close_range)(base + 1, last, flags);
+    }
+    else {
+        status = nextcall(close_range)(first, last, flags);
+    }
+
+    if (status == 0)
+        fd_path_clear_range(first, last);
+    return status;
+}
+
+#else
+typedef int empty_translation_unit;
+#endif
@@ -0,0 +1,38 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <dirent.h>
+#include "libfakechroot.h"
+#include "fd_path.h"
+
+
+/* The descriptor is closed internally */
+wrapper(closedir, int, (DIR * dirp))
+{
+    debug("closedir(&dirp)");
+    if (dirp != NULL) {
+        fd_path_clear(dirfd(dirp));
+    }
+    return nextcall(closedir)(dirp);
+}
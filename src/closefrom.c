@@ -0,0 +1,61 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#ifdef HAVE_CLOSEFROM
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <unistd.h>
+#include "libfakechroot.h"
+#ifndef HAVE_CLOSE_RANGE
+#include "close.h"
+#endif
+#include "fd_path.h"
+
+
+wrapper(closefrom, void, (int lowfd))
+{
+#ifndef HAVE_CLOSE_RANGE
+    int fd;
+#endif
+
+    debug("closefrom(%d)", lowfd);
+
+    /* The base descriptor stays open, so the other threads never see it closed */
+    if (fakechroot_base_fd != -1 && fakechroot_base_fd >= lowfd) {
+#ifdef HAVE_CLOSE_RANGE
+        if (lowfd < fakechroot_base_fd)
+            (void)close_range(lowfd < 0 ? 0 : lowfd, fakechroot_base_fd - 1, 0);
+#else
+        for (fd = lowfd < 0 ? 0 : lowfd; fd < fakechroot_base_fd; fd++)
+            (void)nextcall(close)(fd);
+#endif
+        nextcall(closefrom)(fakechroot_base_fd + 1);
+    }
+    else {
+        nextcall(closefrom)(lowfd);
+    }
+    fd_path_clear_range(lowfd < 0 ? 0 : lowfd, UINT_MAX);
+}
+
+#else
+typedef int empty_translation_unit;
+#endif
@@ -0,0 +1,201 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+
+#include "libfakechroot.h"
+#include "cmd_subst.h"
+
+
+/*
+ * Table of FAKECHROOT_CMD_SUBST=cmd=subst:cmd=subst:...
+ *
+ * The variable is parsed once when the library is loaded and the commands
+ * are kept in an open addressing hash table, so an exec costs one hash of
+ * the file name instead of a scan of the whole list.  The elements are
+ * referenced in place in the environment string, which is never freed.
+ * The tables are static for a short list and mapped for a longer one, as
+ * malloc() can't be used in the constructor.
+ *
+ * A substituted command gets FAKECHROOT_CMD_ORIG with the original file
+ * name, and a process started with this variable doesn't substitute, so the
+ * substitute can run the original command.
+ */
+
+#define CMD_SUBST_ENTRIES_STATIC 64
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+struct cmd_subst_entry {
+    const char *cmd;
+    size_t cmd_len;
+    const char *subst;
+    size_t subst_len;
+    unsigned int hash;
+};
+
+static struct cmd_subst_entry cmd_subst_entries_static[CMD_SUBST_ENTRIES_STATIC];
+static struct cmd_subst_entry *cmd_subst_table_static[2 * CMD_SUBST_ENTRIES_STATIC];
+
+static struct cmd_subst_entry *cmd_subst_entries = cmd_subst_entries_static;
+static struct cmd_subst_entry **cmd_subst_table = cmd_subst_table_static;
+static unsigned int cmd_subst_table_size = 2 * CMD_SUBST_ENTRIES_STATIC;
+static int cmd_subst_count = 0;
+static int cmd_subst_ready = 0;
+
+LOCAL int cmd_subst_orig = 0;
+
+
+static unsigned int cmd_subst_hash(const char *s, size_t len)
+{
+    unsigned int h = FNV_OFFSET_BASIS;
+    while (len--) {
+        h ^= (unsigned char)*s++;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+
+static struct cmd_subst_entry * cmd_subst_find(const char *cmd, size_t len, unsigned int hash)
+{
+    unsigned int i;
+    struct cmd_subst_entry *e;
+
+    for (i = hash % cmd_subst_table_size; (e = cmd_subst_table[i]) != NULL; i = (i + 1) % cmd_subst_table_size) {
+        if (e->hash == hash && e->cmd_len == len && memcmp(e->cmd, cmd, len) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+
+/* Make room for the number of elements, returns 0 if there isn't */
+static int cmd_subst_alloc(size_t entries)
+{
+#ifdef HAVE_SYS_MMAN_H
+    size_t size = entries * sizeof(struct cmd_subst_entry) + 2 * entries * sizeof(struct cmd_subst_entry *);
+    void *p;
+#endif
+
+    /* The table is built again with the same environment */
+    if (entries <= cmd_subst_table_size / 2) {
+        memset(cmd_subst_table, 0, cmd_subst_table_size * sizeof(*cmd_subst_table));
+        return 1;
+    }
+
+#ifdef HAVE_SYS_MMAN_H
+    if ((p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+        return 0;
+    cmd_subst_entries = p;
+    cmd_subst_table = (struct cmd_subst_entry **)(cmd_subst_entries + entries);
+    cmd_subst_table_size = 2 * entries;
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/* Build the table from FAKECHROOT_CMD_SUBST */
+LOCAL void cmd_subst_init(void)
+{
+    const char *env, *p, *end, *eq;
+    const char *orig = getenv("FAKECHROOT_CMD_ORIG");
+    size_t entries = 1;
+
+    cmd_subst_orig = orig != NULL && *orig != '\0';
+    cmd_subst_count = 0;
+
+    if ((env = getenv("FAKECHROOT_CMD_SUBST")) == NULL)
+        env = "";
+
+    /* Every element but the last one ends with a separator */
+    for (p = env; (p = strchr(p, ':')) != NULL; p++)
+        entries++;
+    if (!cmd_subst_alloc(entries)) {
+        fprintf(stderr, "%s: FAKECHROOT_CMD_SUBST: too many elements, only the first %d are used\n", PACKAGE, CMD_SUBST_ENTRIES_STATIC);
+        entries = CMD_SUBST_ENTRIES_STATIC;
+        cmd_subst_alloc(entries);
+    }
+
+    for (p = env; *p != '\0' && (size_t)cmd_subst_count < entries; p = *end ? end + 1 : end) {
+        struct cmd_subst_entry *e = &cmd_subst_entries[cmd_subst_count];
+        unsigned int i;
+
+        for (end = p; *end != ':' && *end != '\0'; end++);
+        for (eq = p; eq < end && *eq != '='; eq++);
+        if (eq == p || eq == end)
+            continue;
+
+        e->cmd = p;
+        e->cmd_len = eq - p;
+        e->subst = eq + 1;
+        e->subst_len = end - eq - 1;
+        e->hash = cmd_subst_hash(e->cmd, e->cmd_len);
+
+        /* The first element for the command wins */
+        if (cmd_subst_find(e->cmd, e->cmd_len, e->hash) != NULL)
+            continue;
+        for (i = e->hash % cmd_subst_table_size; cmd_subst_table[i] != NULL; i = (i + 1) % cmd_subst_table_size);
+        cmd_subst_table[i] = e;
+        cmd_subst_count++;
+    }
+
+    debug("cmd_subst_init(): %d elements", cmd_subst_count);
+    __atomic_store_n(&cmd_subst_ready, 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Find the substitute for the file name as given by the caller.  Returns
+ * the substitute, which is not terminated, and its length in len, or NULL.
+ */
+LOCAL const char * cmd_subst_lookup(const char *filename, size_t *len)
+{
+    struct cmd_subst_entry *e;
+    size_t filename_len;
+
+    if (!__atomic_load_n(&cmd_subst_ready, __ATOMIC_ACQUIRE))
+        cmd_subst_init();
+
+    if (cmd_subst_count == 0 || cmd_subst_orig || filename == NULL)
+        return NULL;
+
+    /* "./cmd" is looked up as "/cmd" */
+    if (filename[0] == '.' && filename[1] == '/')
+        filename++;
+    filename_len = strlen(filename);
+
+    if ((e = cmd_subst_find(filename, filename_len, cmd_subst_hash(filename, filename_len))) == NULL)
+        return NULL;
+
+    debug("cmd_subst_lookup(\"%s\"): \"%.*s\"", filename, (int)e->subst_len, e->subst);
+    *len = e->subst_len;
+    return e->subst;
+}
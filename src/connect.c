@@ -33,6 +33,7 @@
 #include <stdio.h>
 
 #include "libfakechroot.h"
+#include "env_snapshot.h"
 #include "strlcpy.h"
 
 #ifdef HAVE_CONNECT_TYPE_ARG2___CONST_SOCKADDR_ARG__
@@ -44,10 +45,9 @@
 
 wrapper(connect, int, (int sockfd, CONNECT_TYPE_ARG2(addr), socklen_t addrlen))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     struct sockaddr_un *addr_un = (struct sockaddr_un *)SOCKADDR_UN(addr);
-    char tmp[FAKECHROOT_PATH_MAX];
+    fakechroot_buf_decl(tmp);
 
     debug("connect(%d, &addr, %d)", sockfd, addrlen);
 
@@ -55,13 +55,15 @@ wrapper(connect, int, (int sockfd, CONNECT_TYPE_ARG2(addr), socklen_t addrlen))
         socklen_t newaddrlen;
         struct sockaddr_un newaddr_un;
 
-        const char *af_unix_path = getenv("FAKECHROOT_AF_UNIX_PATH");
         const int af_unix_path_max = sizeof(addr_un->sun_path);
         const char *path = addr_un->sun_path;
+        ssize_t af_unix_path_len;
 
-        if (af_unix_path != NULL) {
-            tmp[af_unix_path_max + 1] = '\0';
-            snprintf(tmp, af_unix_path_max + 1, "%s/%s", af_unix_path, path);
+        /* The directory is copied to tmp already cut like by snprintf() */
+        if ((af_unix_path_len = env_snapshot_get(ENV_SNAPSHOT_AF_UNIX_PATH, tmp, af_unix_path_max + 1)) != -1) {
+            if (af_unix_path_len > af_unix_path_max)
+                af_unix_path_len = af_unix_path_max;
+            snprintf(tmp + af_unix_path_len, af_unix_path_max + 1 - af_unix_path_len, "/%s", path);
             path = tmp;
         }
         else {
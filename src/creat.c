@@ -29,8 +29,7 @@
 
 wrapper(creat, int, (const char * pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("creat(\"%s\", 0%o)", pathname, mode);
     expand_chroot_path(pathname);
     return nextcall(creat)(pathname, mode);
@@ -30,8 +30,7 @@
 
 wrapper(creat64, int, (const char * pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("creat64(\"%s\", 0%o)", pathname, mode);
     expand_chroot_path(pathname);
     return nextcall(creat64)(pathname, mode);
@@ -20,101 +20,155 @@
 
 #include <config.h>
 
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
 #include "libfakechroot.h"
-#include "strlcpy.h"
-
-/* mini_httpd - small HTTP server
- **
- ** Copyright © 1999,2000 by Jef Poskanzer <jef@mail.acme.com>.
- ** All rights reserved.
- **
- ** Redistribution and use in source and binary forms, with or without
- ** modification, are permitted provided that the following conditions
- ** are met:
- ** 1. Redistributions of source code must retain the above copyright
- **    notice, this list of conditions and the following disclaimer.
- ** 2. Redistributions in binary form must reproduce the above copyright
- **    notice, this list of conditions and the following disclaimer in the
- **    documentation and/or other materials provided with the distribution.
- **
- ** THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
- ** ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- ** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- ** ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
- ** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
- ** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
- ** OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
- ** HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
- ** LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
- ** OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
- ** SUCH DAMAGE.
+#include "strchrnul.h"
+
+
+/*
+ * Canonicalize the path in place: collapse multiple slashes, remove "."
+ * components and resolve ".." against the previous component.  The result
+ * is the same as the one of the original dedotdot() from mini_httpd:
+ *
+ *  - ".." never goes above "/" for absolute paths;
+ *  - a relative path which goes above its start keeps the leading ".." and
+ *    the rest of the path is left unresolved, ie. "a/../../b/../c" gives
+ *    "../b/../c";
+ *  - a trailing slash is kept and the empty result is ".".
+ *
+ * The path is read once from left to right.  The output is written behind
+ * the read position and it is used as a stack of components: ".." pops the
+ * last one by scanning back to its slash, so every character is moved at
+ * most twice.
  */
 
-#include <string.h>
 
-LOCAL void dedotdot(char * file)
+/* Return the pointer to the first '/' or '\0' character */
+#if defined(__SSE2__)
+
+/* Aligned loads never cross a page boundary so reading past '\0' is safe */
+static inline const char * dedotdot_scan(const char *p)
 {
-    char c, *cp, *cp2;
-    int l;
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i zero = _mm_setzero_si128();
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    __m128i v = _mm_load_si128((const __m128i *)block);
+    unsigned int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_cmpeq_epi8(v, zero)));
+
+    mask &= ~0U << (p - block);
+    while (mask == 0) {
+        block += 16;
+        v = _mm_load_si128((const __m128i *)block);
+        mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, slash), _mm_cmpeq_epi8(v, zero)));
+    }
+    return block + __builtin_ctz(mask);
+}
 
-    if (!file || !*file)
-        return;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
 
-    /* Collapse any multiple / sequences. */
-    while ((cp = strstr(file, "//")) != (char*) 0) {
-        for (cp2 = cp + 2; *cp2 == '/'; ++cp2)
-            continue;
-        (void) strlcpy(cp + 1, cp2, strlen(cp2) + 1);
-    }
+/* Aligned loads never cross a page boundary so reading past '\0' is safe */
+static inline uint64_t dedotdot_scan_mask(const char *block)
+{
+    const uint8x16_t v = vld1q_u8((const uint8_t *)block);
+    const uint8x16_t m = vorrq_u8(vceqq_u8(v, vdupq_n_u8('/')), vceqq_u8(v, vdupq_n_u8(0)));
+
+    /* 4 bits for each byte */
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+
+static inline const char * dedotdot_scan(const char *p)
+{
+    const char *block = (const char *)((uintptr_t)p & ~(uintptr_t)15);
+    uint64_t mask = dedotdot_scan_mask(block);
 
-    /* Remove leading ./ and any /./ sequences. */
-    while (strncmp(file, "./", 2) == 0)
-        (void) strlcpy(file, file + 2, strlen(file) - 1);
-    while ((cp = strstr(file, "/./")) != (char*) 0)
-        (void) strlcpy(cp, cp + 2, strlen(cp) - 1);
-
-    /* Alternate between removing leading ../ and removing foo/../ */
-    for (;;) {
-        while (strncmp(file, "/../", 4) == 0)
-            (void) strlcpy(file, file + 3, strlen(file) - 2);
-        cp = strstr(file, "/../");
-        if (cp == (char*) 0 || strncmp(file, "../", 3) == 0)
-            break;
-        for (cp2 = cp - 1; cp2 >= file && *cp2 != '/'; --cp2)
-            continue;
-        (void) strlcpy(cp2 + 1, cp + 4, strlen(cp) - 3);
+    mask &= ~(uint64_t)0 << (4 * (p - block));
+    while (mask == 0) {
+        block += 16;
+        mask = dedotdot_scan_mask(block);
     }
+    return block + (__builtin_ctzll(mask) >> 2);
+}
+
+#else
+
+static inline const char * dedotdot_scan(const char *p)
+{
+    return strchrnul(p, '/');
+}
+
+#endif
+
 
-    /* Also elide any foo/.. at the end. */
-    while (strncmp(file, "../", 3) != 0 && (l = strlen(file)) > 3
-            && strcmp((cp = file + l - 3), "/..") == 0) {
+/* Returns the length of the result */
+LOCAL size_t dedotdot(char * file)
+{
+    char *r, *w, *e, *root, *cp;
+    int absolute, frozen = 0;
+    size_t len, l;
+
+    if (!file || !*file)
+        return 0;
 
-        for (cp2 = cp - 1; cp2 > file && *cp2 != '/'; --cp2)
-            continue;
+    r = w = file;
+    absolute = *file == '/';
+    if (absolute) {
+        for (w++; *r == '/'; r++);
+    }
+    root = w;
 
-        if (cp2 < file)
-            break;
-        if (strncmp(cp2, "../", 3) == 0)
-            break;
+    while (*r != '\0') {
+        const int slash = *(e = (char *)dedotdot_scan(r)) == '/';
 
-        c = *cp2;
-        *cp2 = '\0';
+        len = e - r;
 
-        if (file == cp2 && c == '/') {
-            strcpy(file, "/");
+        if (len == 1 && r[0] == '.' && slash) {
+            /* Skip "./" */
         }
+        else if (len == 2 && r[0] == '.' && r[1] == '.' && !frozen && (w > root || absolute)) {
+            /* Pop the last component, "/.." is "/" */
+            if (w > root) {
+                for (w--; w > root && w[-1] != '/'; w--);
+                if (!slash && w > root)
+                    w--;
+            }
+        }
+        else {
+            /* Relative path above its start is left as is */
+            if (len == 2 && r[0] == '.' && r[1] == '.' && slash)
+                frozen = 1;
+            if (w != r)
+                memmove(w, r, len);
+            w += len;
+            if (slash)
+                *w++ = '/';
+        }
+
+        for (r = e; *r == '/'; r++);
     }
+    *w = '\0';
 
     /* Correct some paths */
     if (*file == '\0') {
         strcpy(file, ".");
     }
-    else if (strcmp(file, "/.") == 0 || strcmp(file, "/..") == 0) {
+    else if (strcmp(file, "/.") == 0) {
         strcpy(file, "/");
     }
 
-    /* Any /. and the end */
+    /* Any /. at the end */
     for (l = strlen(file); l > 3 && strcmp((cp = file + l - 2), "/.") == 0; l -= 2) {
         *cp = '\0';
     }
+
+    return l;
 }
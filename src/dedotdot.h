@@ -21,6 +21,8 @@
 #ifndef __DE_DOTDOT_H
 #define __DE_DOTDOT_H
 
-void dedotdot(char *);
+#include <stddef.h>
+
+size_t dedotdot(char *);
 
 #endif
@@ -29,8 +29,7 @@
 
 wrapper(dlmopen, void *, (Lmid_t nsid, const char * filename, int flag))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("dlmopen(&nsid, \"%s\", %d)", filename, flag);
     expand_chroot_path(filename);
     return nextcall(dlmopen)(nsid, filename, flag);
@@ -0,0 +1,41 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <unistd.h>
+#include "libfakechroot.h"
+#include "base_fd.h"
+#include "fd_path.h"
+
+
+wrapper(dup2, int, (int oldfd, int newfd))
+{
+    int status;
+
+    debug("dup2(%d, %d)", oldfd, newfd);
+    /* Keep the base descriptor if the program takes its number */
+    if (newfd != -1 && newfd == fakechroot_base_fd && oldfd != newfd) {
+        base_fd_open();
+    }
+    if ((status = nextcall(dup2)(oldfd, newfd)) != -1) {
+        fd_path_dup(oldfd, newfd);
+    }
+    return status;
+}
@@ -0,0 +1,149 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strchrnul.h"
+
+#include "libfakechroot.h"
+#include "env_snapshot.h"
+
+
+/*
+ * Copy of the environment variables which are read by the wrappers, so a
+ * wrapper doesn't scan environ with getenv() on each call.
+ *
+ * The copy is taken when the library is loaded and it is refreshed after
+ * the environment is changed with setenv(), unsetenv(), putenv() or
+ * clearenv(), either by the program through the wrappers or by the library
+ * itself.  A program which writes to environ directly is not seen.
+ *
+ * Each value is guarded by a sequence counter: the writer makes it odd
+ * while the value is copied and readers retry until they see the same even
+ * counter before and after the copy.
+ */
+
+struct env_snapshot_value {
+    unsigned long seq;
+    int set;
+    size_t len;
+    char value[ENV_SNAPSHOT_VALUE_MAX];
+};
+
+static const char * const env_snapshot_names[ENV_SNAPSHOT_COUNT] = {
+    "FAKECHROOT_AF_UNIX_PATH"
+};
+
+static struct env_snapshot_value env_snapshot_values[ENV_SNAPSHOT_COUNT];
+static int env_snapshot_ready = 0;
+
+
+static void env_snapshot_refresh(int id)
+{
+    struct env_snapshot_value *v = &env_snapshot_values[id];
+    const char *value = getenv(env_snapshot_names[id]);
+    unsigned long seq;
+    size_t n;
+
+    for (;;) {
+        seq = __atomic_load_n(&v->seq, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(&v->seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    v->set = value != NULL;
+    v->len = value != NULL ? strlen(value) : 0;
+    n = v->len < ENV_SNAPSHOT_VALUE_MAX ? v->len : ENV_SNAPSHOT_VALUE_MAX - 1;
+    memcpy(v->value, value != NULL ? value : "", n);
+    v->value[n] = '\0';
+
+    __atomic_store_n(&v->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+LOCAL void env_snapshot_init(void)
+{
+    int id;
+
+    for (id = 0; id < ENV_SNAPSHOT_COUNT; id++)
+        env_snapshot_refresh(id);
+    __atomic_store_n(&env_snapshot_ready, 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Refresh the copy after the variable was changed.  The name may be
+ * followed by "=value" as given to putenv(); NULL refreshes everything.
+ */
+LOCAL void env_snapshot_update(const char *name)
+{
+    size_t len;
+    int id;
+
+    if (name == NULL) {
+        env_snapshot_init();
+        return;
+    }
+
+    len = strchrnul(name, '=') - name;
+    for (id = 0; id < ENV_SNAPSHOT_COUNT; id++) {
+        if (strncmp(env_snapshot_names[id], name, len) == 0 && env_snapshot_names[id][len] == '\0') {
+            debug("env_snapshot_update(\"%.*s\")", (int)len, name);
+            env_snapshot_refresh(id);
+        }
+    }
+}
+
+
+/*
+ * Copy the value of the variable to buf, cut to the size of the buffer.
+ * Returns the length of the whole value or -1 if the variable is not set.
+ */
+LOCAL ssize_t env_snapshot_get(int id, char *buf, size_t size)
+{
+    struct env_snapshot_value *v = &env_snapshot_values[id];
+    unsigned long seq;
+    ssize_t len;
+    size_t n;
+
+    if (!__atomic_load_n(&env_snapshot_ready, __ATOMIC_ACQUIRE))
+        env_snapshot_init();
+
+    for (;;) {
+        seq = __atomic_load_n(&v->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+        len = v->set ? (ssize_t)v->len : -1;
+        if (len != -1 && size > 0) {
+            /* A torn length is still within both buffers */
+            n = (size_t)len < size ? (size_t)len : size - 1;
+            if (n >= ENV_SNAPSHOT_VALUE_MAX)
+                n = ENV_SNAPSHOT_VALUE_MAX - 1;
+            memcpy(buf, v->value, n);
+            buf[n] = '\0';
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&v->seq, __ATOMIC_RELAXED) == seq)
+            return len;
+    }
+}
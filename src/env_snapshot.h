@@ -0,0 +1,35 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __ENV_SNAPSHOT_H
+#define __ENV_SNAPSHOT_H
+
+#include <sys/types.h>
+
+/* Longer values are cut; the socket paths are shorter anyway */
+#define ENV_SNAPSHOT_VALUE_MAX 256
+
+#define ENV_SNAPSHOT_AF_UNIX_PATH 0
+#define ENV_SNAPSHOT_COUNT 1
+
+void env_snapshot_init(void);
+void env_snapshot_update(const char *);
+ssize_t env_snapshot_get(int, char *, size_t);
+
+#endif
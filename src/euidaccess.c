@@ -27,8 +27,7 @@
 
 wrapper(euidaccess, int, (const char * pathname, int mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("euidaccess(\"%s\", %d)", pathname, mode);
     expand_chroot_path(pathname);
     return nextcall(euidaccess)(pathname, mode);
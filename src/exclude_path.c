@@ -0,0 +1,167 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+#include <string.h>
+
+#include "libfakechroot.h"
+#include "exclude_path.h"
+
+
+/*
+ * Prefix index for ANDROID_EXCLUDE_PATH.
+ *
+ * A path is excluded if one of the list elements is equal to the path or
+ * to its leading part ending just before a '/'.  Instead of comparing the
+ * path with every element, the elements are kept in an open addressing hash
+ * table keyed by the whole element.  The path is hashed once from left to
+ * right and the table is probed only at component boundaries, so the check
+ * costs one probe per path component regardless of the length of the list.
+ *
+ * The list is a compile-time string literal, so the elements are referenced
+ * in place and the tables are sized from the literal: there is no limit on
+ * the number or the length of the elements and no malloc in the constructor
+ * (it causes corruption on Android).
+ */
+
+#define EXCLUDE_PATH_LIST_SIZE sizeof(ANDROID_EXCLUDE_PATH "")
+
+/* Every element takes at least one character and a separator */
+#define EXCLUDE_PATH_ENTRIES_MAX (EXCLUDE_PATH_LIST_SIZE / 2 + 1)
+
+/* The next power of two above twice the number of elements always fits */
+#define EXCLUDE_PATH_TABLE_SIZE (4 * EXCLUDE_PATH_ENTRIES_MAX)
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+struct exclude_path_entry {
+    const char *path;
+    size_t len;
+    unsigned int hash;
+};
+
+static struct exclude_path_entry exclude_path_entries[EXCLUDE_PATH_ENTRIES_MAX];
+static struct exclude_path_entry *exclude_path_table[EXCLUDE_PATH_TABLE_SIZE];
+static unsigned int exclude_path_mask = 0;
+static size_t exclude_path_min_len = 0;
+static size_t exclude_path_max_len = 0;
+static unsigned int exclude_path_count = 0;
+
+
+static unsigned int exclude_path_hash(const char *s, size_t len)
+{
+    unsigned int h = FNV_OFFSET_BASIS;
+    while (len--) {
+        h ^= (unsigned char)*s++;
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+
+static struct exclude_path_entry * exclude_path_lookup(const char *path, size_t len, unsigned int hash)
+{
+    unsigned int i;
+    struct exclude_path_entry *e;
+
+    for (i = hash & exclude_path_mask; (e = exclude_path_table[i]) != NULL; i = (i + 1) & exclude_path_mask) {
+        if (e->hash == hash && e->len == len && memcmp(e->path, path, len) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+
+/* Build the index from ANDROID_EXCLUDE_PATH */
+LOCAL void exclude_path_init(void)
+{
+    const char *list = ANDROID_EXCLUDE_PATH;
+    const char *p, *end;
+    unsigned int size, i;
+
+    exclude_path_count = 0;
+    exclude_path_min_len = 0;
+    exclude_path_max_len = 0;
+
+    for (p = list; *p != '\0'; p = *end ? end + 1 : end) {
+        struct exclude_path_entry *e = &exclude_path_entries[exclude_path_count];
+
+        for (end = p; *end != ':' && *end != '\0'; end++);
+        /* An empty element would exclude every absolute path */
+        if (end == p)
+            continue;
+
+        e->path = p;
+        e->len = end - p;
+        e->hash = exclude_path_hash(p, e->len);
+        exclude_path_count++;
+
+        if (exclude_path_min_len == 0 || e->len < exclude_path_min_len)
+            exclude_path_min_len = e->len;
+        if (e->len > exclude_path_max_len)
+            exclude_path_max_len = e->len;
+    }
+
+    for (size = 1; size < 2 * exclude_path_count; size <<= 1);
+    exclude_path_mask = size - 1;
+    memset(exclude_path_table, 0, sizeof(exclude_path_table));
+
+    for (i = 0; i < exclude_path_count; i++) {
+        struct exclude_path_entry *e = &exclude_path_entries[i];
+        unsigned int j;
+
+        /* Duplicated elements are harmless but would waste probes */
+        if (exclude_path_lookup(e->path, e->len, e->hash) != NULL)
+            continue;
+        for (j = e->hash & exclude_path_mask; exclude_path_table[j] != NULL; j = (j + 1) & exclude_path_mask);
+        exclude_path_table[j] = e;
+    }
+
+    debug("exclude_path_init(): %u elements", exclude_path_count);
+}
+
+
+/* Check if the absolute path is on the exclude list */
+LOCAL int exclude_path_match(const char *path)
+{
+    unsigned int h = FNV_OFFSET_BASIS;
+    size_t i;
+
+    if (exclude_path_count == 0 || path == NULL)
+        return 0;
+
+    for (i = 0; i <= exclude_path_max_len; i++) {
+        const char c = path[i];
+
+        if ((c == '/' || c == '\0') && i >= exclude_path_min_len) {
+            if (exclude_path_lookup(path, i, h) != NULL)
+                return 1;
+        }
+        if (c == '\0')
+            break;
+
+        h ^= (unsigned char)c;
+        h *= FNV_PRIME;
+    }
+
+    return 0;
+}
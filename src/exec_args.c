@@ -0,0 +1,330 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_ALLOCA_H
+# include <alloca.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+
+#include "libfakechroot.h"
+#include "cmd_subst.h"
+#include "exec_args.h"
+#include "exec_plan.h"
+#include "open.h"
+#include "preserve_env.h"
+#include "android-config.h"
+#include "vfork_child.h"
+
+
+/*
+ * Builder of the arguments for execve() and posix_spawn().  Every program
+ * is started by the ELF loader:
+ *
+ *   binary: [argv0, --argv0, argv0, filename, user_args...]
+ *   script: [argv0, --argv0, argv0, interpreter, interp_args...,
+ *            filename, user_args...]
+ *
+ * The first argv0 is the argv[0] of the loader seen by ps(1) and the one
+ * after --argv0 is the argv[0] of the program, so login shells still see
+ * "-bash" and scripts see the right $0.  The interpreter and its optional
+ * arguments come from the "#!" line.  The original argv[0] is replaced.
+ *
+ * The environment is the caller's one with the variables from
+ * preserve_env_list added from environ if they are missing, which takes one
+ * pass over each environment.
+ *
+ * A command found in FAKECHROOT_CMD_SUBST is a host program: it is started
+ * directly instead of the ELF loader with the caller's argv and with
+ * FAKECHROOT_CMD_ORIG set to the original file name.  FAKECHROOT_CMD_ORIG
+ * is dropped from a copied environment otherwise.
+ *
+ * Everything is counted first and the arrays and the strings which are not
+ * owned by the caller are stored in a single block of exactly the right
+ * size, so there is no limit on the number of arguments.
+ *
+ * The path runs in vfork() children and signal handlers, so it doesn't
+ * allocate: the block is taken from the stack and only a block bigger than
+ * EXEC_ARGS_STACK_MAX is mapped.  A vfork() child always takes the block
+ * from the stack, which it borrows from its suspended parent: a mapping
+ * would stay in the address space of the parent after execve().
+ */
+
+/* Small enough for the threads with 128 KB stacks */
+#define EXEC_ARGS_STACK_MAX (16 * 1024)
+
+#define is_hashbang_space(c) ((c) == ' ' || (c) == '\t')
+
+#define CMD_ORIG_VAR "FAKECHROOT_CMD_ORIG="
+#define CMD_ORIG_VAR_LEN (sizeof(CMD_ORIG_VAR) - 1)
+
+
+/* Read the "#!" line of the file or use the cached one; return its length, 0 for a binary or -1 */
+static ssize_t exec_args_hashbang(const char *filename, char *hashbang, struct exec_plan_id *plan_id, struct exec_plan *plan, int *plan_hit)
+{
+    ssize_t len;
+    char *eol;
+    int file;
+
+    if ((*plan_hit = exec_plan_lookup(filename, plan_id, plan))) {
+        if (!plan->script)
+            return 0;
+        memcpy(hashbang, plan->line, plan->line_len);
+        hashbang[plan->line_len] = '\0';
+        return plan->line_len;
+    }
+
+    if ((file = nextcall(open)(filename, O_RDONLY)) == -1)
+        return -1;
+    len = read(file, hashbang, FAKECHROOT_PATH_MAX - 1);
+    close(file);
+    if (len == -1)
+        return -1;
+
+    if (len < 2 || hashbang[0] != '#' || hashbang[1] != '!') {
+        exec_plan_store(plan_id, 0, NULL, 0, NULL);
+        return 0;
+    }
+
+    /* The line ends with a newline or with the first NUL */
+    if ((eol = memchr(hashbang, '\n', len)) != NULL)
+        len = eol - hashbang;
+    hashbang[len] = '\0';
+    return strlen(hashbang);
+}
+
+
+/*
+ * Build the argv and envp for the ELF loader and pass them to fn; return
+ * its result or -1 with errno if the arguments can't be built.
+ */
+LOCAL int exec_args_run(int fakechroot_stats_frame, const char *filename, char * const argv[], char * const envp[], exec_args_fn fn, void *data)
+{
+    scratch_decl(struct fakechroot_path, fakechroot_path);
+    fakechroot_buf_decl(path);
+    fakechroot_buf_decl(hashbang);
+    fakechroot_buf_decl(interpreter);
+    struct exec_plan_id plan_id;
+    struct exec_plan plan;
+    int plan_hit;
+    const char *argv0, *interpreter_orig = NULL, *subst;
+    const char **preserve_val;
+    unsigned int preserve;
+    size_t argc, envc, preservec, user_argc, nargv, size, j;
+    size_t path_len, interpreter_len = 0, token_len = 0, interp_argc = 0, subst_len = 0;
+    ssize_t line_len = 0;
+    char **block, **ap, **ep, *sp, *p, *exec_path;
+    char *empty_list[1] = { NULL };
+    int status, saved_errno, mapped = 0, copy_env;
+
+    for (argc = 0; argv != NULL && argv[argc] != NULL; argc++);
+    for (envc = 0; envp != NULL && envp[envc] != NULL; envc++);
+
+    argv0 = argc > 0 ? argv[0] : filename;
+    user_argc = argc > 0 ? argc - 1 : 0;
+
+    /* Variables from preserve_env_list which are missing in envp */
+    preserve_val = alloca(preserve_env_list_count * sizeof(const char *));
+    preserve = preserve_env_scan(environ, preserve_val) & ~preserve_env_scan(envp, NULL);
+    size = 0;
+    for (preservec = 0, j = 0; j < (size_t)preserve_env_list_count; j++) {
+        if (!(preserve & (1U << j)))
+            continue;
+        if (*preserve_val[j] == '\0') {
+            preserve &= ~(1U << j);
+            continue;
+        }
+        preservec++;
+        size += strlen(preserve_env_list[j]) + strlen(preserve_val[j]) + 2;
+    }
+
+    if ((subst = cmd_subst_lookup(filename, &subst_len)) != NULL) {
+        /* No argv is built, the caller's one is passed as is */
+        nargv = 0;
+        path_len = strlen(filename);
+        size += subst_len + 1 + CMD_ORIG_VAR_LEN + path_len + 1;
+    }
+    else {
+        /* The translated path is needed until the block is filled */
+        expand_chroot_path(filename);
+        path_len = strlen(filename);
+        memcpy(path, filename, path_len + 1);
+
+        if ((line_len = exec_args_hashbang(path, hashbang, &plan_id, &plan, &plan_hit)) == -1) {
+            __set_errno(ENOENT);
+            return -1;
+        }
+
+        if (line_len > 0) {
+            /* Count the arguments of the interpreter */
+            for (p = hashbang + 2; is_hashbang_space(*p); p++);
+            if (*p == '\0') {
+                __set_errno(ENOEXEC);
+                return -1;
+            }
+            interpreter_orig = p;
+            for (; *p != '\0'; p++) {
+                if (!is_hashbang_space(*p) && (p == interpreter_orig || is_hashbang_space(p[-1])))
+                    interp_argc++;
+            }
+            interp_argc--;
+
+            for (token_len = 0; interpreter_orig[token_len] != '\0' && !is_hashbang_space(interpreter_orig[token_len]); token_len++);
+
+            if (plan_hit && plan.interpreter[0] != '\0') {
+                interpreter_len = strlen(plan.interpreter);
+                memcpy(interpreter, plan.interpreter, interpreter_len + 1);
+            }
+            else {
+                const char *ptr = interpreter;
+
+                memcpy(interpreter, interpreter_orig, token_len);
+                interpreter[token_len] = '\0';
+                expand_chroot_path(ptr);
+                interpreter_len = strlen(ptr);
+                memmove(interpreter, ptr, interpreter_len + 1);
+
+                /* A relative interpreter depends on the current directory */
+                if (!plan_hit)
+                    exec_plan_store(&plan_id, 1, hashbang, line_len, *interpreter_orig == '/' ? interpreter : NULL);
+            }
+        }
+
+        nargv = 4 + user_argc + (line_len > 0 ? 1 + interp_argc + 1 : 0) + 1;
+        size += path_len + 1;
+        if (line_len > 0)
+            size += interpreter_len + 1 + line_len + 1;
+    }
+    size += nargv * sizeof(char *);
+
+    /* The caller's envp is passed as is if nothing is added or dropped */
+    copy_env = preservec > 0 || subst != NULL || cmd_subst_orig;
+    if (copy_env)
+        size += (preservec + envc + (subst != NULL) + 1) * sizeof(char *);
+
+    if (size <= EXEC_ARGS_STACK_MAX || vfork_child()) {
+        block = alloca(size);
+    }
+    else {
+#ifdef HAVE_SYS_MMAN_H
+        block = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block == MAP_FAILED) {
+            __set_errno(ENOMEM);
+            return -1;
+        }
+        mapped = 1;
+#else
+        block = alloca(size);
+#endif
+    }
+    ap = block;
+    ep = block + nargv;
+    sp = copy_env ? (char *)(ep + preservec + envc + (subst != NULL) + 1) : (char *)ep;
+
+    if (subst != NULL) {
+        exec_path = memcpy(sp, subst, subst_len);
+        exec_path[subst_len] = '\0';
+        sp += subst_len + 1;
+    }
+    else {
+        exec_path = (char *)ANDROID_ELFLOADER;
+
+        *ap++ = (char *)argv0;
+        *ap++ = (char *)ANDROID_ARGV0_OPT;
+        *ap++ = (char *)argv0;
+
+        if (line_len > 0) {
+            *ap++ = memcpy(sp, interpreter, interpreter_len + 1);
+            sp += interpreter_len + 1;
+
+            /* Split the rest of the line after the interpreter */
+            p = memcpy(sp, interpreter_orig, hashbang + line_len - interpreter_orig + 1);
+            sp += hashbang + line_len - interpreter_orig + 1;
+            for (p += token_len; *p != '\0'; p++) {
+                if (is_hashbang_space(*p))
+                    *p = '\0';
+                else if (p[-1] == '\0')
+                    *ap++ = p;
+            }
+        }
+
+        *ap++ = memcpy(sp, path, path_len + 1);
+        sp += path_len + 1;
+
+        if (user_argc > 0)
+            memcpy(ap, argv + 1, user_argc * sizeof(char *));
+        ap[user_argc] = NULL;
+    }
+
+    if (copy_env) {
+        for (j = 0; j < (size_t)preserve_env_list_count; j++) {
+            size_t key_len, val_len;
+
+            if (!(preserve & (1U << j)))
+                continue;
+            key_len = strlen(preserve_env_list[j]);
+            val_len = strlen(preserve_val[j]);
+            *ep++ = sp;
+            memcpy(sp, preserve_env_list[j], key_len);
+            sp[key_len] = '=';
+            memcpy(sp + key_len + 1, preserve_val[j], val_len + 1);
+            sp += key_len + val_len + 2;
+        }
+        if (subst != NULL) {
+            *ep++ = sp;
+            memcpy(sp, CMD_ORIG_VAR, CMD_ORIG_VAR_LEN);
+            memcpy(sp + CMD_ORIG_VAR_LEN, filename, path_len + 1);
+            sp += CMD_ORIG_VAR_LEN + path_len + 1;
+        }
+        for (j = 0; j < envc; j++) {
+            if (strncmp(envp[j], CMD_ORIG_VAR, CMD_ORIG_VAR_LEN) != 0)
+                *ep++ = envp[j];
+        }
+        *ep = NULL;
+        ep = block + nargv;
+    }
+    else {
+        ep = envp != NULL ? (char **)envp : empty_list;
+    }
+
+    if (subst != NULL)
+        status = fn(exec_path, argv != NULL ? (char **)argv : empty_list, ep, data);
+    else
+        status = fn(exec_path, block, ep, data);
+
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) {
+        saved_errno = errno;
+        munmap(block, size);
+        __set_errno(saved_errno);
+    }
+#endif
+
+    return status;
+}
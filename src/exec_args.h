@@ -0,0 +1,28 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __EXEC_ARGS_H
+#define __EXEC_ARGS_H
+
+/* Called with the path, argv and envp of the ELF loader or of the substitute */
+typedef int (*exec_args_fn)(const char *, char **, char **, void *);
+
+int exec_args_run(int, const char *, char * const [], char * const [], exec_args_fn, void *);
+
+#endif
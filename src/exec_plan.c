@@ -0,0 +1,158 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "libfakechroot.h"
+#include "exec_plan.h"
+#include "statx.h"
+
+
+/*
+ * Cache of what execve() and posix_spawn() have found in the executables:
+ * an ELF binary or a script with its "#!" line and translated interpreter.
+ *
+ * The entries are keyed by the identity of the file from a single statx():
+ * device, inode, size, mtime and ctime, so a rewritten, replaced or chmoded
+ * file is read again.  A file replaced between statx() and open() is stored
+ * with the old identity which won't match it later.
+ *
+ * The table is direct-mapped and every entry is guarded by a sequence
+ * counter, the same as the descriptor table in fd_path.c: a writer which
+ * can't get the entry gives up and a reader which sees it changing treats
+ * it as a miss.  The table lives in the memory of the process, so it is
+ * shared with a vfork() child and lost with exec.
+ */
+
+#define EXEC_PLAN_ENTRIES 32
+#define EXEC_PLAN_LOCK_TRIES 1000
+#define EXEC_PLAN_READ_TRIES 4
+
+struct exec_plan_entry {
+    unsigned long seq;
+    struct exec_plan_id id;
+    struct exec_plan plan;
+};
+
+static struct exec_plan_entry exec_plan_table[EXEC_PLAN_ENTRIES];
+
+
+static struct exec_plan_entry * exec_plan_entry(const struct exec_plan_id *id)
+{
+    unsigned long long h = (id->ino ^ (id->dev << 17)) * 0x9e3779b97f4a7c15ULL;
+    return &exec_plan_table[(h >> 32) % EXEC_PLAN_ENTRIES];
+}
+
+
+static int exec_plan_id_equal(const struct exec_plan_id *a, const struct exec_plan_id *b)
+{
+    return a->dev == b->dev && a->ino == b->ino && a->size == b->size &&
+        a->mtime_sec == b->mtime_sec && a->mtime_nsec == b->mtime_nsec &&
+        a->ctime_sec == b->ctime_sec && a->ctime_nsec == b->ctime_nsec;
+}
+
+
+/* Get the identity of the file and copy its cached plan, return 1 on hit */
+LOCAL int exec_plan_lookup(const char *path, struct exec_plan_id *id, struct exec_plan *plan)
+{
+#ifdef HAVE_STATX
+    struct exec_plan_entry *entry;
+    struct statx stx;
+    unsigned long seq;
+    int i;
+
+    id->valid = 0;
+
+    if (nextcall(statx)(AT_FDCWD, path, 0, STATX_TYPE | STATX_MODE | STATX_INO | STATX_SIZE | STATX_MTIME | STATX_CTIME, &stx) != 0)
+        return 0;
+    if ((stx.stx_mask & (STATX_TYPE | STATX_INO | STATX_SIZE | STATX_MTIME | STATX_CTIME)) != (STATX_TYPE | STATX_INO | STATX_SIZE | STATX_MTIME | STATX_CTIME) || !S_ISREG(stx.stx_mode))
+        return 0;
+
+    id->dev = ((unsigned long long)stx.stx_dev_major << 32) | stx.stx_dev_minor;
+    id->ino = stx.stx_ino;
+    id->size = stx.stx_size;
+    id->mtime_sec = stx.stx_mtime.tv_sec;
+    id->mtime_nsec = stx.stx_mtime.tv_nsec;
+    id->ctime_sec = stx.stx_ctime.tv_sec;
+    id->ctime_nsec = stx.stx_ctime.tv_nsec;
+    id->valid = 1;
+
+    entry = exec_plan_entry(id);
+    for (i = 0; i < EXEC_PLAN_READ_TRIES; i++) {
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1))
+            return 0;
+        if (!exec_plan_id_equal(&entry->id, id))
+            return 0;
+        memcpy(plan, &entry->plan, sizeof(*plan));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq) {
+            if (plan->line_len >= sizeof(plan->line) || plan->interpreter[sizeof(plan->interpreter) - 1] != '\0')
+                return 0;
+            debug("exec_plan_lookup(\"%s\"): %s", path, plan->script ? "script" : "binary");
+            return 1;
+        }
+    }
+#else
+    (void)path;
+    (void)plan;
+    id->valid = 0;
+#endif
+    return 0;
+}
+
+
+/* Remember the plan for the file with the identity from exec_plan_lookup() */
+LOCAL void exec_plan_store(const struct exec_plan_id *id, int script, const char *line, size_t line_len, const char *interpreter)
+{
+    struct exec_plan_entry *entry;
+    unsigned long seq;
+    size_t interpreter_len = 0;
+    int i;
+
+    if (!id->valid)
+        return;
+    if (script && line_len >= EXEC_PLAN_LINE_MAX)
+        return;
+    if (interpreter != NULL && (interpreter_len = strlen(interpreter)) >= sizeof(entry->plan.interpreter))
+        return;
+
+    entry = exec_plan_entry(id);
+    for (i = 0; ; i++) {
+        if (i == EXEC_PLAN_LOCK_TRIES)
+            return;
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(&entry->seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    entry->id = *id;
+    entry->plan.script = script;
+    entry->plan.line_len = script ? line_len : 0;
+    if (script)
+        memcpy(entry->plan.line, line, line_len);
+    memcpy(entry->plan.interpreter, interpreter != NULL ? interpreter : "", interpreter_len + 1);
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
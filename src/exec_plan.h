@@ -0,0 +1,56 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __EXEC_PLAN_H
+#define __EXEC_PLAN_H
+
+#include <stddef.h>
+
+#include "libfakechroot.h"
+
+/* Longer "#!" lines and interpreters are not cached */
+#define EXEC_PLAN_LINE_MAX 256
+
+/* Identity of the executable file */
+struct exec_plan_id {
+    int valid;
+    unsigned long long dev;
+    unsigned long long ino;
+    unsigned long long size;
+    long long mtime_sec;
+    long long ctime_sec;
+    unsigned int mtime_nsec;
+    unsigned int ctime_nsec;
+};
+
+/* What execve() found in the file */
+struct exec_plan {
+    /* The file starts with "#!" */
+    int script;
+    /* The "#!" line up to the newline */
+    size_t line_len;
+    char line[EXEC_PLAN_LINE_MAX];
+    /* The translated interpreter or "" if it has to be translated again */
+    char interpreter[FAKECHROOT_BASE_LEN + EXEC_PLAN_LINE_MAX];
+};
+
+int exec_plan_lookup(const char *, struct exec_plan_id *, struct exec_plan *);
+void exec_plan_store(const struct exec_plan_id *, int, const char *, size_t, const char *);
+
+#endif
@@ -30,6 +30,7 @@
 #include <unistd.h>
 #include "strchrnul.h"
 #include "libfakechroot.h"
+#include "path_cache.h"
 
 #ifndef __GLIBC__
 extern char **environ;
@@ -57,7 +58,9 @@ wrapper(execvp, int, (const char * file, char * const argv[]))
         return execve(file, argv, environ);
     } else {
         int got_eacces = 0;
-        char *path, *p, *name;
+        char *path, *p, *name, *end;
+        struct path_cache_search search;
+        int cached;
         size_t len;
         size_t pathlen;
 
@@ -85,6 +88,27 @@ wrapper(execvp, int, (const char * file, char * const argv[]))
         /* And add the slash.  */
         *--name = '/';
 
+        /* Try the directory where the file was found before */
+        if ((cached = path_cache_lookup(&search, path, file)) >= 0) {
+            char *startp;
+
+            for (p = path; cached-- > 0; p = strchrnul(p, ':') + 1);
+            end = strchrnul(p, ':');
+            startp = (char *) memcpy(name - (end - p), p, end - p);
+            execve(startp, argv, environ);
+
+            switch (errno) {
+            case EACCES:
+            case ENOENT:
+            case ESTALE:
+            case ENOTDIR:
+                /* Search again */
+                break;
+            default:
+                return -1;
+            }
+        }
+
         p = path;
         do {
             char *startp;
@@ -99,7 +123,12 @@ wrapper(execvp, int, (const char * file, char * const argv[]))
             else
                 startp = (char *) memcpy(name - (p - path), path, p - path);
 
-            /* Try to execute this name.  If it works, execv will not return.  */
+            /* Try to execute this name.  If it works, execv will not return.
+               The cache is stored before as a vfork child shares it with
+               its parent, so only if the file is there.  */
+            path_cache_dir(&search, path, p - path);
+            if (search.cacheable && access(startp, X_OK) == 0)
+                path_cache_store(&search, file);
             execve(startp, argv, environ);
 
             switch (errno) {
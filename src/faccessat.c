@@ -25,14 +25,27 @@
 #define _ATFILE_SOURCE
 #include <unistd.h>
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(faccessat, int, (int dirfd, const char * pathname, int mode, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+#ifdef HAVE_RAW_SYSCALLS
+    const char *relpath;
+    int retval;
+#endif
     debug("faccessat(%d, \"%s\", %d, %d)", dirfd, pathname, mode, flags);
     expand_chroot_path_at(dirfd, pathname);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        retval = rawcall(faccessat)(fakechroot_base_fd, relpath, mode, flags);
+    else
+        retval = rawcall(faccessat)(dirfd, pathname, mode, flags);
+    /* The C library emulates the flags on kernels without faccessat2(2) */
+    if (retval == 0 || errno != ENOSYS)
+        return retval;
+#endif
     return nextcall(faccessat)(dirfd, pathname, mode, flags);
 }
 
@@ -31,8 +31,7 @@
 
 wrapper(fchmodat, int, (int dirfd, const char * path, mode_t mode, int flag))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("fchmodat(%d, \"%s\", 0%o, %d)", dirfd, path, mode, flag);
     expand_chroot_path_at(dirfd, path);
     return nextcall(fchmodat)(dirfd, path, mode, flag);
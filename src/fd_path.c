@@ -0,0 +1,325 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+
+#include "libfakechroot.h"
+#include "fd_path.h"
+#include "dedotdot.h"
+#include "readlink.h"
+#include "vfork_child.h"
+
+
+/*
+ * Registry of the paths inside the fake chroot which the descriptors were
+ * opened with, so a directory descriptor passed to the *at() functions is
+ * resolved without fchdir() and getcwd().
+ *
+ * The paths registered by the open wrappers are lexical: a directory opened
+ * through a symlink gets the path of the link, and a directory renamed
+ * since keeps its old path, but the kernel resolves ".." below it against
+ * the parent of the real directory.  The lexical path is good enough for
+ * the relative paths without "..", ie. to check them with the exclude list,
+ * and fd_path_lookup() reads the real path from /proc/self/fd each time
+ * rel2absat() needs the directory.
+ *
+ * The table is indexed by the descriptor and split into chunks which are
+ * mapped on the first use.  Every slot is guarded by a sequence counter:
+ * the writer makes it odd while the path is changed and the reader retries
+ * if it has seen an odd or changed counter.  A writer which can't get the
+ * slot gives up and the old path stays.  A slot left odd by a thread
+ * interrupted by fork() in the middle is never trusted.
+ *
+ * The descriptors closed behind the back of the wrappers would leave stale
+ * paths, so fclose() and closedir() are wrapped as well as close() and
+ * dup2().  A vfork() child has its own descriptors but shares the table
+ * with the parent, so it doesn't change the table.
+ */
+
+#define FD_PATH_CHUNK_SIZE 64
+#define FD_PATH_CHUNKS 1024
+#define FD_PATH_LOCK_TRIES 1000
+#define FD_PATH_READ_TRIES 4
+
+struct fd_path_slot {
+    unsigned long seq;
+    size_t len;
+    char path[FAKECHROOT_PATH_MAX];
+};
+
+static struct fd_path_slot *fd_path_chunks[FD_PATH_CHUNKS];
+
+
+static struct fd_path_slot * fd_path_slot(int fd, int create)
+{
+    struct fd_path_slot *chunk, *expected = NULL;
+    const size_t size = FD_PATH_CHUNK_SIZE * sizeof(struct fd_path_slot);
+
+    if (fd < 0 || fd >= FD_PATH_CHUNK_SIZE * FD_PATH_CHUNKS)
+        return NULL;
+
+    chunk = __atomic_load_n(&fd_path_chunks[fd / FD_PATH_CHUNK_SIZE], __ATOMIC_ACQUIRE);
+    if (chunk == NULL) {
+        if (!create)
+            return NULL;
+#ifdef HAVE_SYS_MMAN_H
+        chunk = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (chunk == MAP_FAILED)
+            return NULL;
+#else
+        if ((chunk = calloc(1, size)) == NULL)
+            return NULL;
+#endif
+        if (!__atomic_compare_exchange_n(&fd_path_chunks[fd / FD_PATH_CHUNK_SIZE], &expected, chunk, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+#ifdef HAVE_SYS_MMAN_H
+            munmap(chunk, size);
+#else
+            free(chunk);
+#endif
+            chunk = expected;
+        }
+    }
+
+    return &chunk[fd % FD_PATH_CHUNK_SIZE];
+}
+
+
+static int fd_path_lock(struct fd_path_slot *slot, unsigned long *seqp)
+{
+    unsigned long seq;
+    int i;
+
+    for (i = 0; i < FD_PATH_LOCK_TRIES; i++) {
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(&slot->seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            *seqp = seq;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static void fd_path_unlock(struct fd_path_slot *slot, unsigned long seq)
+{
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+/* Copy the registered path of the descriptor to buf and return its length or -1 */
+LOCAL ssize_t fd_path_get(int fd, char *buf)
+{
+    struct fd_path_slot *slot;
+    unsigned long seq;
+    size_t len;
+    int i;
+
+    if ((slot = fd_path_slot(fd, 0)) == NULL)
+        return -1;
+
+    for (i = 0; i < FD_PATH_READ_TRIES; i++) {
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+        len = __atomic_load_n(&slot->len, __ATOMIC_RELAXED);
+        if (len == 0 || len >= FAKECHROOT_PATH_MAX)
+            return -1;
+        memcpy(buf, slot->path, len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+            buf[len] = '\0';
+            return len;
+        }
+    }
+    return -1;
+}
+
+
+/* Register the path of the descriptor */
+LOCAL void fd_path_set(int fd, const char *path, size_t len)
+{
+    struct fd_path_slot *slot;
+    unsigned long seq;
+
+    if (vfork_child())
+        return;
+
+    if (path == NULL || len == 0 || len >= FAKECHROOT_PATH_MAX) {
+        fd_path_clear(fd);
+        return;
+    }
+
+    if ((slot = fd_path_slot(fd, 1)) == NULL || !fd_path_lock(slot, &seq))
+        return;
+    memcpy(slot->path, path, len);
+    __atomic_store_n(&slot->len, len, __ATOMIC_RELAXED);
+    fd_path_unlock(slot, seq);
+}
+
+
+/* Forget the path of the descriptor */
+LOCAL void fd_path_clear(int fd)
+{
+    struct fd_path_slot *slot;
+    unsigned long seq;
+
+    if ((slot = fd_path_slot(fd, 0)) == NULL)
+        return;
+    if (__atomic_load_n(&slot->len, __ATOMIC_RELAXED) == 0)
+        return;
+    if (vfork_child())
+        return;
+
+    if (!fd_path_lock(slot, &seq))
+        return;
+    __atomic_store_n(&slot->len, 0, __ATOMIC_RELAXED);
+    fd_path_unlock(slot, seq);
+}
+
+
+/* Forget the paths of the descriptors from first to last, both included */
+LOCAL void fd_path_clear_range(unsigned int first, unsigned int last)
+{
+    const unsigned int max = FD_PATH_CHUNK_SIZE * FD_PATH_CHUNKS - 1;
+    unsigned int fd = first;
+
+    if (last > max)
+        last = max;
+    if (vfork_child())
+        return;
+
+    while (fd <= last) {
+        /* Skip the chunks which were never mapped */
+        if (__atomic_load_n(&fd_path_chunks[fd / FD_PATH_CHUNK_SIZE], __ATOMIC_ACQUIRE) == NULL) {
+            fd = (fd / FD_PATH_CHUNK_SIZE + 1) * FD_PATH_CHUNK_SIZE;
+            continue;
+        }
+        fd_path_clear(fd);
+        fd++;
+    }
+}
+
+
+/* Copy the path of the old descriptor to the new one */
+LOCAL void fd_path_dup(int oldfd, int newfd)
+{
+    fakechroot_buf_decl(path);
+    ssize_t len;
+
+    if (oldfd == newfd)
+        return;
+    if ((len = fd_path_get(oldfd, path)) == -1) {
+        fd_path_clear(newfd);
+        return;
+    }
+    fd_path_set(newfd, path, len);
+}
+
+
+/*
+ * Copy the registered path of the directory descriptor joined with the
+ * relative path to buf and return its length or -1.  The result is
+ * normalized with dedotdot().
+ */
+LOCAL ssize_t fd_path_get_at(int dirfd, const char *path, char *buf)
+{
+    ssize_t dirlen;
+    size_t len;
+
+    if ((dirlen = fd_path_get(dirfd, buf)) == -1)
+        return -1;
+
+    len = strlen(path);
+    if (dirlen + 1 + len >= FAKECHROOT_PATH_MAX)
+        return -1;
+    buf[dirlen] = '/';
+    memcpy(buf + dirlen + 1, path, len + 1);
+
+    len = dedotdot(buf);
+    if (len > 1 && buf[len - 1] == '/')
+        buf[--len] = '\0';
+    return len;
+}
+
+
+/*
+ * Copy the real path of the descriptor from /proc/self/fd to buf and return
+ * its length or -1.  It is not remembered as the directory can be renamed.
+ * The link points to the host path which is narrowed the same way as the
+ * result of readlink().
+ */
+LOCAL ssize_t fd_path_lookup(int fd, char *buf)
+{
+    char proc[sizeof("/proc/self/fd/") + 3 * sizeof(int)];
+    ssize_t len;
+
+    snprintf(proc, sizeof(proc), "/proc/self/fd/%d", fd);
+    if ((len = nextcall(readlink)(proc, buf, FAKECHROOT_PATH_MAX - 1)) <= 0)
+        return -1;
+    buf[len] = '\0';
+
+    /* Not a path, ie. "socket:[1234]" or an unlinked directory */
+    if (*buf != '/' || (len > 10 && strcmp(buf + len - 10, " (deleted)") == 0))
+        return -1;
+
+    return narrow_chroot_path(buf);
+}
+
+
+/*
+ * Register the descriptor just opened with the path which was returned by
+ * expand_chroot_path() or expand_chroot_path_at() for the buffer.
+ */
+LOCAL void fd_path_register(int fd, struct fakechroot_path *fp, int dirfd, const char *path)
+{
+    char *abspath = fp->buf + FAKECHROOT_BASE_LEN;
+    ssize_t len;
+
+    if (fd < 0)
+        return;
+
+    /* Translated */
+    if (path == fp->buf) {
+        fd_path_set(fd, abspath, fp->len - FAKECHROOT_BASE_LEN);
+        return;
+    }
+
+    /* Resolved but excluded */
+    if (path == abspath && *abspath == '/') {
+        fd_path_set(fd, abspath, fp->len);
+        return;
+    }
+
+    /* Passed through below the directory descriptor */
+    if (path != NULL && *path != '/' && dirfd != AT_FDCWD && (len = fd_path_get_at(dirfd, path, abspath)) != -1) {
+        fd_path_set(fd, abspath, len);
+        return;
+    }
+
+    fd_path_clear(fd);
+}
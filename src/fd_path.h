@@ -0,0 +1,36 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __FD_PATH_H
+#define __FD_PATH_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "libfakechroot.h"
+
+ssize_t fd_path_get(int, char *);
+ssize_t fd_path_get_at(int, const char *, char *);
+ssize_t fd_path_lookup(int, char *);
+void fd_path_set(int, const char *, size_t);
+void fd_path_clear(int);
+void fd_path_clear_range(unsigned int, unsigned int);
+void fd_path_dup(int, int);
+void fd_path_register(int, struct fakechroot_path *, int, const char *);
+
+#endif
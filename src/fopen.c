@@ -26,8 +26,7 @@
 
 wrapper(fopen, FILE *, (const char * path, const char * mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("fopen(\"%s\", \"%s\")", path, mode);
     expand_chroot_path(path);
     return nextcall(fopen)(path, mode);
@@ -29,8 +29,7 @@
 
 wrapper(fopen64, FILE *, (const char * path, const char * mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("fopen64(\"%s\", \"%s\")", path, mode);
     expand_chroot_path(path);
     return nextcall(fopen64)(path, mode);
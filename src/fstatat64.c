@@ -28,14 +28,23 @@
 #include <sys/stat.h>
 #include <limits.h>
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 wrapper(fstatat64, int, (int dirfd, const char *pathname, struct stat64 *buf, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("fstatat64(%d, \"%s\", &buf, %d)", dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, flags);
+    return rawcall(fstatat64)(dirfd, pathname, buf, flags);
+#else
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(fstatat64)(fakechroot_base_fd, relpath, buf, flags);
     return nextcall(fstatat64)(dirfd, pathname, buf, flags);
+#endif
 }
 
 #else
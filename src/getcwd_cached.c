@@ -0,0 +1,132 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+#include <string.h>
+
+#include "libfakechroot.h"
+#include "getcwd_cached.h"
+#include "getcwd_real.h"
+#include "tls.h"
+#include "vfork_child.h"
+
+
+/*
+ * The working directory is shared by all threads but every relative path
+ * needs it, so each thread keeps its own copy of the last getcwd() result
+ * together with the generation it was read at.  The wrappers which change
+ * the directory (chdir, fchdir, chroot) or can move it (rename) bump the
+ * global generation, which makes every copy stale at once.  Changes made
+ * by other processes to the ancestors of the directory are not seen.
+ *
+ * The generation is read before getcwd() so a concurrent change leaves the
+ * copy marked with an older generation and it is refreshed on the next call.
+ * A vfork() child shares the copy of its parent, so it doesn't mark the
+ * copy it reads: after a chdir() in the child the parent would see the
+ * directory of the child with the current generation.
+ */
+
+static unsigned long getcwd_generation = 1;
+
+
+static struct fakechroot_tls * getcwd_cached_refresh(void)
+{
+    struct fakechroot_tls *tls;
+    unsigned long generation;
+    char *cwd;
+    size_t len;
+
+    if ((tls = fakechroot_tls()) == NULL)
+        return NULL;
+
+    generation = __atomic_load_n(&getcwd_generation, __ATOMIC_ACQUIRE);
+    if (tls->cwd_generation == generation)
+        return tls;
+
+    tls->cwd_generation = 0;
+
+    cwd = tls->cwd_host;
+    if (getcwd_real(cwd, FAKECHROOT_PATH_MAX) == NULL)
+        return NULL;
+
+    len = strlen(cwd);
+    tls->cwd_host_len = len;
+    tls->cwd_path = cwd;
+    tls->cwd_path_len = len;
+
+    /* Same as narrow_chroot_path() but the host path is kept */
+    if (len >= FAKECHROOT_BASE_LEN && memcmp(cwd, ANDROID_BASE, FAKECHROOT_BASE_LEN) == 0) {
+        if (len == FAKECHROOT_BASE_LEN) {
+            tls->cwd_path = "/";
+            tls->cwd_path_len = 1;
+        }
+        else if (cwd[FAKECHROOT_BASE_LEN] == '/') {
+            tls->cwd_path = cwd + FAKECHROOT_BASE_LEN;
+            tls->cwd_path_len = len - FAKECHROOT_BASE_LEN;
+        }
+    }
+
+    if (!vfork_child())
+        tls->cwd_generation = generation;
+
+    debug("getcwd_cached_refresh(): \"%s\"", cwd);
+    return tls;
+}
+
+
+/* Working directory as seen inside the fake chroot or NULL on error */
+LOCAL const char * getcwd_cached(size_t *lenp)
+{
+    struct fakechroot_tls *tls = getcwd_cached_refresh();
+
+    if (tls == NULL)
+        return NULL;
+    if (lenp != NULL)
+        *lenp = tls->cwd_path_len;
+    return tls->cwd_path;
+}
+
+
+/* Real working directory or NULL on error */
+LOCAL const char * getcwd_cached_host(size_t *lenp)
+{
+    struct fakechroot_tls *tls = getcwd_cached_refresh();
+
+    if (tls == NULL)
+        return NULL;
+    if (lenp != NULL)
+        *lenp = tls->cwd_host_len;
+    return tls->cwd_host;
+}
+
+
+/* Current generation of the working directory, never 0 */
+LOCAL unsigned long getcwd_cached_generation(void)
+{
+    return __atomic_load_n(&getcwd_generation, __ATOMIC_ACQUIRE);
+}
+
+
+/* Called after the working directory has been changed */
+LOCAL void getcwd_cached_invalidate(void)
+{
+    __atomic_add_fetch(&getcwd_generation, 1, __ATOMIC_RELEASE);
+}
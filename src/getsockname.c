@@ -60,7 +60,7 @@ wrapper(getsockname, int, (int s, GETSOCKNAME_TYPE_ARG2(addr), socklen_t * addrl
             path_max = sizeof(addr_un->sun_path);
         }
         if (addr_un->sun_path && *(addr_un->sun_path)) {
-            char tmp[FAKECHROOT_PATH_MAX];
+            fakechroot_buf_decl(tmp);
             strlcpy(tmp, addr_un->sun_path, FAKECHROOT_PATH_MAX);
             narrow_chroot_path(tmp);
             strlcpy(addr_un->sun_path, tmp, path_max);
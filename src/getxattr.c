@@ -29,8 +29,7 @@
 
 wrapper(getxattr, ssize_t, (const char * path, const char * name, void * value, size_t size))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("getxattr(\"%s\", \"%s\", &value, %zd)", path, name, size);
     expand_chroot_path(path);
     return nextcall(getxattr)(path, name, value, size);
@@ -26,7 +26,7 @@
 
 wrapper(glob, int, (const char * pattern, int flags, int (* errfunc) (const char *, int), glob_t * pglob))
 {
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     int rc, i;
 
     debug("glob(\"%s\", %d, &errfunc, &pglob)", pattern, flags);
@@ -37,20 +37,7 @@ wrapper(glob, int, (const char * pattern, int flags, int (* errfunc) (const char
         return rc;
 
     for (i = 0; i < pglob->gl_pathc; i++) {
-        const char *fakechroot_base = getenv("FAKECHROOT_BASE");
-        char tmp[FAKECHROOT_PATH_MAX], *tmpptr;
-
-        strcpy(tmp, pglob->gl_pathv[i]);
-
-        if (fakechroot_base != NULL) {
-            const char *ptr = strstr(tmp, fakechroot_base);
-            if (ptr != tmp) {
-                tmpptr = tmp;
-            } else {
-                tmpptr = tmp + strlen(fakechroot_base);
-            }
-            strcpy(pglob->gl_pathv[i], tmpptr);
-        }
+        narrow_chroot_path(pglob->gl_pathv[i]);
     }
     return rc;
 }
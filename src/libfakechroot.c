@@ -33,55 +33,56 @@
 #include <stdio.h>
 #include <pwd.h>
 #include <dlfcn.h>
+#include <fcntl.h>
 
 #include "setenv.h"
 #include "libfakechroot.h"
-#include "getcwd_real.h"
 #include "strchrnul.h"
+#include "base_fd.h"
+#include "cmd_subst.h"
+#include "env_snapshot.h"
+#include "exclude_path.h"
+#include "fd_path.h"
+#include "getcwd_cached.h"
+#include "preserve_env.h"
+#include "stats.h"
+#include "trace.h"
+#include "translation_cache.h"
+#include "vfork_child.h"
 
-#define EXCLUDE_LIST_SIZE 100
-#define EXCLUDE_PATH_MAX 256
-
-/* Useful to exclude a list of directories or files */
-/* Use static buffers to avoid malloc in constructor (causes corruption on Android) */
-static char exclude_list_storage[EXCLUDE_LIST_SIZE][EXCLUDE_PATH_MAX];
-static char *exclude_list[EXCLUDE_LIST_SIZE];
-static int exclude_length[EXCLUDE_LIST_SIZE];
-static int list_max = 0;
 static int first = 0;
 
 
-/* List of environment variables to preserve on clearenv() */
-char *preserve_env_list[] = {
-    "FAKECHROOT_DEBUG",
-    "FAKEROOTKEY",
-    "FAKED_MODE",
-    "LD_LIBRARY_PATH",
-    "LD_PRELOAD"
-};
-const int preserve_env_list_count = sizeof preserve_env_list / sizeof preserve_env_list[0];
+/* Resolved once in fakechroot_init() */
+LOCAL int fakechroot_debug_enabled = -1;
 
 
 LOCAL int fakechroot_debug (const char *fmt, ...)
 {
-    int ret;
-    char newfmt[2048];
+    char buf[2048];
+    size_t len = sizeof(PACKAGE ": ") - 1;
     va_list ap;
+    int ret;
 
-    /* Check FAKECHROOT_DEBUG BEFORE va_start to avoid undefined behavior.
-     * Calling va_start without va_end is undefined behavior that can
-     * corrupt the stack/heap on some architectures. */
-    if (!getenv("FAKECHROOT_DEBUG"))
+    /* A wrapper can be called before the constructor */
+    if (fakechroot_debug_enabled == -1)
+        fakechroot_debug_enabled = getenv("FAKECHROOT_DEBUG") != NULL;
+    if (!fakechroot_debug_enabled)
         return 0;
 
-    va_start(ap, fmt);
-
-    snprintf(newfmt, sizeof(newfmt), PACKAGE ": %s\n", fmt);
+    memcpy(buf, PACKAGE ": ", len);
 
-    ret = vfprintf(stderr, newfmt, ap);
+    va_start(ap, fmt);
+    ret = vsnprintf(buf + len, sizeof(buf) - len - 1, fmt, ap);
     va_end(ap);
 
-    return ret;
+    if (ret < 0)
+        return ret;
+    len += (size_t)ret < sizeof(buf) - len - 1 ? (size_t)ret : sizeof(buf) - len - 2;
+    buf[len++] = '\n';
+
+    /* A single write(2) so the lines of threads and processes don't mix */
+    return write(STDERR_FILENO, buf, len);
 }
 
 
@@ -92,6 +93,8 @@ LOCAL int fakechroot_debug (const char *fmt, ...)
 void fakechroot_init (void) CONSTRUCTOR;
 void fakechroot_init (void)
 {
+    fakechroot_debug_enabled = getenv("FAKECHROOT_DEBUG") != NULL;
+
     debug("fakechroot_init()");
     debug("FAKECHROOT_BASE=\"%s\"", ANDROID_BASE);
 
@@ -101,24 +104,24 @@ void fakechroot_init (void)
 
         first = 1;
 
+        fakechroot_loadfuncs();
+
+        vfork_child_init();
+
         /* We get a list of directories or files */
-        /* Use static storage to avoid malloc in constructor (causes corruption on Android) */
-        if (ANDROID_EXCLUDE_PATH && ANDROID_EXCLUDE_PATH[0] != '\0') {
-            int i;
-            for (i = 0; list_max < EXCLUDE_LIST_SIZE; ) {
-                int j, len;
-                for (j = i; ANDROID_EXCLUDE_PATH[j] != ':' && ANDROID_EXCLUDE_PATH[j] != '\0'; j++);
-                len = j - i;
-                if (len >= EXCLUDE_PATH_MAX) len = EXCLUDE_PATH_MAX - 1;
-                exclude_list[list_max] = exclude_list_storage[list_max];
-                memset(exclude_list[list_max], '\0', EXCLUDE_PATH_MAX);
-                strncpy(exclude_list[list_max], &(ANDROID_EXCLUDE_PATH[i]), len);
-                exclude_length[list_max] = strlen(exclude_list[list_max]);
-                list_max++;
-                if (ANDROID_EXCLUDE_PATH[j] != ':') break;
-                i = j + 1;
-            }
-        }
+        exclude_path_init();
+
+        preserve_env_init();
+
+        cmd_subst_init();
+
+        env_snapshot_init();
+
+        base_fd_init();
+
+        trace_init();
+
+        stats_init();
     }
 }
 
@@ -126,21 +129,59 @@ void fakechroot_init (void)
 /* Lazily load function */
 LOCAL fakechroot_wrapperfn_t fakechroot_loadfunc (struct fakechroot_wrapper * w)
 {
+    fakechroot_wrapperfn_t nextfunc;
     char *msg;
-    if (!(w->nextfunc = dlsym(RTLD_NEXT, w->name))) {;
+    if (!(nextfunc = (fakechroot_wrapperfn_t)dlsym(RTLD_NEXT, w->name))) {
         msg = dlerror();
         fprintf(stderr, "%s: %s: %s\n", PACKAGE, w->name, msg != NULL ? msg : "unresolved symbol");
         exit(EXIT_FAILURE);
     }
-    return w->nextfunc;
+    __atomic_store_n(&w->nextfunc, nextfunc, __ATOMIC_RELEASE);
+    return nextfunc;
+}
+
+
+#ifdef HAVE___ATTRIBUTE__SECTION_DATA_FAKECHROOT
+extern LOCAL struct fakechroot_wrapper __start_data_fakechroot[];
+extern LOCAL struct fakechroot_wrapper __stop_data_fakechroot[];
+#endif
+
+/*
+ * Load all functions at once.  The wrapper descriptors are walked in the
+ * constructor, so the first call of a wrapper doesn't pay for dlsym() and
+ * the threads started later never race on the lookup.  Functions which are
+ * missing in the next library are left for fakechroot_loadfunc() which
+ * reports them only if they are really called.
+ */
+LOCAL void fakechroot_loadfuncs (void)
+{
+#ifdef HAVE___ATTRIBUTE__SECTION_DATA_FAKECHROOT
+    struct fakechroot_wrapper *w;
+    fakechroot_wrapperfn_t nextfunc;
+    int loaded = 0, missing = 0;
+
+    for (w = __start_data_fakechroot; w < __stop_data_fakechroot; w++) {
+        if (w->name == NULL || __atomic_load_n(&w->nextfunc, __ATOMIC_RELAXED) != NULL)
+            continue;
+        if ((nextfunc = (fakechroot_wrapperfn_t)dlsym(RTLD_NEXT, w->name)) != NULL) {
+            __atomic_store_n(&w->nextfunc, nextfunc, __ATOMIC_RELEASE);
+            loaded++;
+        }
+        else {
+            dlerror();
+            missing++;
+        }
+    }
+
+    debug("fakechroot_loadfuncs(): %d loaded, %d missing", loaded, missing);
+#endif
 }
 
 
 /* Check if path is on exclude list */
 LOCAL int fakechroot_localdir (const char * p_path)
 {
-    char *v_path = (char *)p_path;
-    char cwd_path[FAKECHROOT_PATH_MAX];
+    const char *v_path = p_path;
 
     if (!p_path)
         return 0;
@@ -150,62 +191,196 @@ LOCAL int fakechroot_localdir (const char * p_path)
 
     /* We need to expand relative paths */
     if (p_path[0] != '/') {
-        getcwd_real(cwd_path, FAKECHROOT_PATH_MAX);
-        v_path = cwd_path;
-        narrow_chroot_path(v_path);
+        if ((v_path = getcwd_cached(NULL)) == NULL)
+            return 0;
     }
 
     /* We try to find if we need direct access to a file */
-    {
-        const size_t len = strlen(v_path);
-        int i;
-
-        for (i = 0; i < list_max; i++) {
-            if (exclude_length[i] > len ||
-                    v_path[exclude_length[i] - 1] != (exclude_list[i])[exclude_length[i] - 1] ||
-                    strncmp(exclude_list[i], v_path, exclude_length[i]) != 0) continue;
-            if (exclude_length[i] == len || v_path[exclude_length[i]] == '/') return 1;
+    return exclude_path_match(v_path);
+}
+
+
+/* Strip the base from the real path in place and return the new length */
+LOCAL size_t fakechroot_narrow_path (char * path)
+{
+    size_t len;
+
+    if (path == NULL || *path == '\0')
+        return 0;
+
+    len = strlen(path);
+    if (len >= FAKECHROOT_BASE_LEN && memcmp(path, ANDROID_BASE, FAKECHROOT_BASE_LEN) == 0) {
+        if (len == FAKECHROOT_BASE_LEN) {
+            path[0] = '/';
+            path[1] = '\0';
+            return 1;
+        }
+        else if (path[FAKECHROOT_BASE_LEN] == '/') {
+            len -= FAKECHROOT_BASE_LEN;
+            memmove(path, path + FAKECHROOT_BASE_LEN, len + 1);
         }
     }
+    return len;
+}
 
-    return 0;
+
+/*
+ * The absolute path is stored in fp->buf after the room for the base, so
+ * prefixing it is a single copy of the base.  A path longer than PATH_MAX
+ * is cut, but with the base it is still too long for the kernel.
+ */
+static char * fakechroot_prefix_path (struct fakechroot_path * fp, size_t len)
+{
+    memcpy(fp->buf, ANDROID_BASE, FAKECHROOT_BASE_LEN);
+    fp->len = FAKECHROOT_BASE_LEN + len;
+    return fp->buf;
+}
+
+
+/* Add the base to the absolute path unless it is excluded */
+LOCAL char * fakechroot_expand_rel_path (struct fakechroot_path * fp, const char * path)
+{
+    char *abspath = fp->buf + FAKECHROOT_BASE_LEN;
+    size_t len;
+
+    if (path == NULL || *path != '/' || fakechroot_localdir(path))
+        return (char *)path;
+
+    len = strnlen(path, FAKECHROOT_PATH_MAX - 1);
+    memcpy(abspath, path, len);
+    abspath[len] = '\0';
+
+    return fakechroot_prefix_path(fp, len);
 }
 
 
 /*
- * Parse the FAKECHROOT_CMD_SUBST environment variable (the first
- * parameter) and if there is a match with filename, return the
- * substitution in cmd_subst.  Returns non-zero if there was a match.
- *
- * FAKECHROOT_CMD_SUBST=cmd=subst:cmd=subst:...
+ * Return the length of the absolute path if dedotdot() would leave it as
+ * is: no "//", no "." or ".." component and no trailing "/.".  Otherwise
+ * return 0.
  */
-LOCAL int fakechroot_try_cmd_subst (char * env, const char * filename, char * cmd_subst)
+static size_t fakechroot_canonical_len (const char * path)
 {
-    int len, len2;
-    char *p;
+    const char *p = path;
 
-    if (env == NULL || filename == NULL)
+    if (*p != '/')
         return 0;
 
-    /* Remove trailing dot from filename */
-    if (filename[0] == '.' && filename[1] == '/')
-        filename++;
-    len = strlen(filename);
+    for (;;) {
+        p++;
+        if (*p == '/')
+            return 0;
+        if (p[0] == '.' && (p[1] == '/' || p[1] == '\0' || (p[1] == '.' && (p[2] == '/' || p[2] == '\0'))))
+            return 0;
+        while (*p != '/' && *p != '\0')
+            p++;
+        if (*p == '\0')
+            return p - path;
+    }
+}
+
+
+/* Translate the path relative to the working directory */
+LOCAL char * fakechroot_expand_path (struct fakechroot_path * fp, const char * path)
+{
+    char *abspath = fp->buf + FAKECHROOT_BASE_LEN;
+    struct translation_cache_key key;
+    char *result;
+    size_t len;
+
+    if (path == NULL)
+        return NULL;
+
+    /* Most absolute paths are already canonical and don't need rel2abs() */
+    if ((len = fakechroot_canonical_len(path)) != 0 && len < FAKECHROOT_PATH_MAX) {
+        if (fakechroot_localdir(path))
+            return (char *)path;
+        memcpy(abspath, path, len + 1);
+        return fakechroot_prefix_path(fp, len);
+    }
+
+    if (translation_cache_lookup(&key, fp, path, &result))
+        return result;
+
+    if (fakechroot_localdir(path))
+        return translation_cache_store(&key, fp, path, (char *)path);
 
-    do {
-        p = strchrnul(env, ':');
+    rel2abs(path, abspath);
+    fp->len = strlen(abspath);
 
-        if (strncmp(env, filename, len) == 0 && env[len] == '=') {
-            len2 = p - &env[len+1];
-            if (len2 >= FAKECHROOT_PATH_MAX)
-                len2 = FAKECHROOT_PATH_MAX - 1;
-            strncpy(cmd_subst, &env[len+1], len2);
-            cmd_subst[len2] = '\0';
+    if (*abspath != '/')
+        return abspath;
+    if (fakechroot_localdir(abspath))
+        return translation_cache_store(&key, fp, path, abspath);
+
+    return translation_cache_store(&key, fp, path, fakechroot_prefix_path(fp, fp->len));
+}
+
+
+#ifdef HAVE_FCHDIR
+/* Check if the path has a ".." component */
+static int fakechroot_has_dotdot (const char * path)
+{
+    const char *p = path;
+
+    for (;;) {
+        if (p[0] == '.' && p[1] == '.' && (p[2] == '/' || p[2] == '\0'))
             return 1;
-        }
+        p = strchrnul(p, '/');
+        if (*p == '\0')
+            return 0;
+        p++;
+    }
+}
+
+
+/* Translate the path relative to the directory file descriptor */
+LOCAL char * fakechroot_expand_path_at (struct fakechroot_path * fp, int dirfd, const char * path)
+{
+    char *abspath = fp->buf + FAKECHROOT_BASE_LEN;
+    struct translation_cache_key key;
+    char *result;
+
+    if (path == NULL)
+        return NULL;
+
+    /*
+     * The directory behind a real descriptor is already a host directory, so
+     * a relative path below it is resolved by the kernel as it is, unless it
+     * leads to an excluded path which is not under the base.  ".." can climb
+     * above the directory, maybe above the base, and a descriptor without a
+     * registered path could be anywhere: these need rel2absat().
+     */
+    if (dirfd != AT_FDCWD && *path != '/' && !fakechroot_has_dotdot(path)) {
+        if (fd_path_get_at(dirfd, path, abspath) != -1 && !exclude_path_match(abspath))
+            return (char *)path;
+    }
+
+    /* An absolute path doesn't depend on the descriptor */
+    if (*path == '/')
+        return fakechroot_expand_path(fp, path);
+
+    /* Only the working directory is covered by the cache generation */
+    if (dirfd == AT_FDCWD) {
+        if (translation_cache_lookup(&key, fp, path, &result))
+            return result;
+    }
+    else {
+        key.entry = NULL;
+    }
+
+    if (fakechroot_localdir(path))
+        return translation_cache_store(&key, fp, path, (char *)path);
+
+    if (rel2absat(dirfd, path, abspath) == NULL)
+        return (char *)path;
+    fp->len = strlen(abspath);
 
-        env = p;
-    } while (*env++ != '\0');
+    if (*abspath != '/')
+        return abspath;
+    if (fakechroot_localdir(abspath))
+        return translation_cache_store(&key, fp, path, abspath);
 
-    return 0;
+    return translation_cache_store(&key, fp, path, fakechroot_prefix_path(fp, fp->len));
 }
+#endif
@@ -31,7 +31,17 @@
 #include "android-config.h"
 
 
-#define debug fakechroot_debug
+#ifdef __GNUC__
+# define likely(x) __builtin_expect(!!(x), 1)
+# define unlikely(x) __builtin_expect(!!(x), 0)
+#else
+# define likely(x) (x)
+# define unlikely(x) (x)
+#endif
+
+/* The flag is -1 until fakechroot_init() has looked at FAKECHROOT_DEBUG */
+#define debug(...) \
+    (unlikely(fakechroot_debug_enabled) ? fakechroot_debug(__VA_ARGS__) : 0)
 
 
 #ifdef HAVE___ATTRIBUTE__VISIBILITY
@@ -42,14 +52,27 @@
 
 #ifdef HAVE___ATTRIBUTE__CONSTRUCTOR
 # define CONSTRUCTOR __attribute__((constructor))
+# define DESTRUCTOR __attribute__((destructor))
 #else
 # define CONSTRUCTOR
+# define DESTRUCTOR
+#endif
+
+#ifdef HAVE___THREAD
+# define THREAD_LOCAL __thread
 #endif
 
+/*
+ * The wrapper descriptors are collected in one section which is walked in
+ * fakechroot_init().  The section name is a C identifier so the linker
+ * provides the __start_ and __stop_ symbols for it.
+ */
 #ifdef HAVE___ATTRIBUTE__SECTION_DATA_FAKECHROOT
-# define SECTION_DATA_FAKECHROOT __attribute__((section("data.fakechroot")))
+# define SECTION_DATA_FAKECHROOT __attribute__((section("data_fakechroot")))
+# define ALIGNED_FAKECHROOT_WRAPPER __attribute__((aligned(4 * sizeof(void *))))
 #else
 # define SECTION_DATA_FAKECHROOT
+# define ALIGNED_FAKECHROOT_WRAPPER
 #endif
 
 #if defined(PATH_MAX)
@@ -82,60 +105,119 @@
 #endif
 
 
+/* The base is a string literal so its length is known at compile time */
+#define FAKECHROOT_BASE_LEN (sizeof(ANDROID_BASE) - 1)
+
+/* Buffer for a translated path which leaves room for the base prefix */
+struct fakechroot_path {
+    size_t len;
+    char buf[FAKECHROOT_BASE_LEN + FAKECHROOT_PATH_MAX];
+};
+
+/*
+ * With FAKECHROOT_STATS the wrapper gets a statistics frame which is
+ * closed by the cleanup attribute when the function returns.
+ */
+#ifdef __GNUC__
+# define stats_frame_decl() \
+    int fakechroot_stats_frame __attribute__((cleanup(fakechroot_stats_cleanup))) = \
+        unlikely(fakechroot_stats_enabled) ? fakechroot_stats_enter(__func__) : 0
+#else
+# define stats_frame_decl() \
+    const int fakechroot_stats_frame = 0
+#endif
+
+#define stats_chroot_path_begin() \
+    unsigned long long fakechroot_stats_start = unlikely(fakechroot_stats_frame) ? fakechroot_stats_now() : 0
+
+#define stats_chroot_path_end(path) \
+    { \
+        if (unlikely(fakechroot_stats_frame)) \
+            fakechroot_stats_translate(fakechroot_stats_frame, fakechroot_stats_start, (path) == fakechroot_path->buf); \
+    }
+
+/*
+ * Path buffers are taken from the per-thread arena of the library so a
+ * wrapper doesn't need PATH_MAX bytes of stack for each of them, which is
+ * too much for the threads with small stacks.  The buffer is given back when
+ * the variable goes out of scope.  If the arena is exhausted the buffer is
+ * allocated on the stack of the caller.
+ */
+#define FAKECHROOT_SCRATCH_SIZE sizeof(struct fakechroot_path)
+
+#ifdef __GNUC__
+# define scratch_decl(type, name) \
+    type *name __attribute__((cleanup(fakechroot_scratch_cleanup))) = \
+        fakechroot_scratch_acquire() ?: __builtin_alloca(FAKECHROOT_SCRATCH_SIZE)
+#else
+# define scratch_decl(type, name) \
+    type name##_storage[FAKECHROOT_SCRATCH_SIZE / sizeof(type)], *name = name##_storage
+#endif
+
+/* The buffer has at least FAKECHROOT_PATH_MAX bytes */
+#define fakechroot_buf_decl(name) \
+    scratch_decl(char, name)
+
+#define fakechroot_path_decl() \
+    scratch_decl(struct fakechroot_path, fakechroot_path); \
+    stats_frame_decl()
+
 #define narrow_chroot_path(path) \
+    fakechroot_narrow_path((char *)(path))
+
+/* Records the translation if FAKECHROOT_TRACE is set */
+#define trace_chroot_path(in, out) \
     { \
-        if ((path) != NULL && *((char *)(path)) != '\0') { \
-            if (ANDROID_BASE != NULL) { \
-                char *fakechroot_ptr = strstr((path), ANDROID_BASE); \
-                if (fakechroot_ptr == (path)) { \
-                    const size_t fakechroot_base_len = strlen(ANDROID_BASE); \
-                    const size_t path_len = strlen(path); \
-                    if (path_len == fakechroot_base_len) { \
-                        ((char *)(path))[0] = '/'; \
-                        ((char *)(path))[1] = '\0'; \
-                    } \
-                    else if ( ((char *)(path))[fakechroot_base_len] == '/' ) { \
-                        memmove((void *)(path), (path) + fakechroot_base_len, 1 + path_len - fakechroot_base_len); \
-                    } \
-                } \
-            } \
+        if (unlikely(fakechroot_trace_enabled)) { \
+            static unsigned long fakechroot_trace_site = 0; \
+            fakechroot_trace(&fakechroot_trace_site, __func__, (in), (out), fakechroot_path); \
         } \
     }
 
 #define expand_chroot_rel_path(path) \
     { \
-        if (!fakechroot_localdir(path)) { \
-            if ((path) != NULL && *((char *)(path)) == '/') { \
-                if (ANDROID_BASE != NULL ) { \
-                    snprintf(fakechroot_buf, FAKECHROOT_PATH_MAX, "%s%s", ANDROID_BASE, (path)); \
-                    (path) = fakechroot_buf; \
-                } \
-            } \
-        } \
+        const char *fakechroot_path_orig = (path); \
+        stats_chroot_path_begin(); \
+        (path) = fakechroot_expand_rel_path(fakechroot_path, (path)); \
+        stats_chroot_path_end(path); \
+        trace_chroot_path(fakechroot_path_orig, (path)); \
     }
 
 #define expand_chroot_path(path) \
     { \
-        if (!fakechroot_localdir(path)) { \
-            if ((path) != NULL) { \
-                rel2abs((path), fakechroot_abspath); \
-                (path) = fakechroot_abspath; \
-                expand_chroot_rel_path(path); \
-            } \
-        } \
+        const char *fakechroot_path_orig = (path); \
+        stats_chroot_path_begin(); \
+        (path) = fakechroot_expand_path(fakechroot_path, (path)); \
+        stats_chroot_path_end(path); \
+        trace_chroot_path(fakechroot_path_orig, (path)); \
     }
 
 #define expand_chroot_path_at(dirfd, path) \
     { \
-        if (!fakechroot_localdir(path)) { \
-            if ((path) != NULL) { \
-                rel2absat(dirfd, (path), fakechroot_abspath); \
-                (path) = fakechroot_abspath; \
-                expand_chroot_rel_path(path); \
-            } \
-        } \
+        const char *fakechroot_path_orig = (path); \
+        stats_chroot_path_begin(); \
+        (path) = fakechroot_expand_path_at(fakechroot_path, (dirfd), (path)); \
+        stats_chroot_path_end(path); \
+        trace_chroot_path(fakechroot_path_orig, (path)); \
     }
 
+/*
+ * The translated path relative to the base directory descriptor or NULL if
+ * the descriptor is not open or the path was not prefixed with the base.
+ * The base itself and a remainder which still starts with '/' are left to
+ * the string path.
+ */
+#define fakechroot_base_path(path) \
+    (fakechroot_base_fd != -1 && (path) == fakechroot_path->buf && \
+     fakechroot_path->len > FAKECHROOT_BASE_LEN + 1 && \
+     fakechroot_path->buf[FAKECHROOT_BASE_LEN + 1] != '/' ? \
+        fakechroot_path->buf + FAKECHROOT_BASE_LEN + 1 : NULL)
+
+/* Check if the host path is the base directory or a path below it */
+#define fakechroot_in_base(path) \
+    (strncmp((path), ANDROID_BASE, FAKECHROOT_BASE_LEN) == 0 && \
+     ((path)[FAKECHROOT_BASE_LEN] == '\0' || (path)[FAKECHROOT_BASE_LEN] == '/'))
+
 
 #define wrapper_decl_proto(function) \
     extern LOCAL struct fakechroot_wrapper fakechroot_##function##_wrapper_decl SECTION_DATA_FAKECHROOT
@@ -179,10 +261,9 @@
 
 #define nextcall(function) \
     ( \
+      (unlikely(fakechroot_stats_enabled) ? fakechroot_stats_nextcall(__func__) : (void)0), \
       (fakechroot_##function##_fn_t)( \
-          fakechroot_##function##_wrapper_decl.nextfunc ? \
-          fakechroot_##function##_wrapper_decl.nextfunc : \
-          fakechroot_loadfunc(&fakechroot_##function##_wrapper_decl) \
+          fakechroot_nextfunc(&fakechroot_##function##_wrapper_decl) \
       ) \
     )
 
@@ -217,20 +298,63 @@
 
 typedef void (*fakechroot_wrapperfn_t)(void);
 
+/*
+ * The descriptors in the section are aligned to their rounded up size so the
+ * compiler cannot insert its own padding between them and the section can be
+ * walked as an array.
+ */
 struct fakechroot_wrapper {
     fakechroot_wrapperfn_t func;
     fakechroot_wrapperfn_t nextfunc;
     const char *name;
-};
+} ALIGNED_FAKECHROOT_WRAPPER;
 
 
 extern char *preserve_env_list[];
 extern const int preserve_env_list_count;
+extern LOCAL int fakechroot_base_fd;
+extern LOCAL int fakechroot_debug_enabled;
+extern LOCAL int fakechroot_trace_enabled;
+extern LOCAL int fakechroot_stats_enabled;
 
 int fakechroot_debug (const char *, ...);
 fakechroot_wrapperfn_t fakechroot_loadfunc (struct fakechroot_wrapper *);
+void fakechroot_loadfuncs (void);
 int fakechroot_localdir (const char *);
-int fakechroot_try_cmd_subst (char *, const char *, char *);
+size_t fakechroot_narrow_path (char *);
+char * fakechroot_expand_rel_path (struct fakechroot_path *, const char *);
+char * fakechroot_expand_path (struct fakechroot_path *, const char *);
+char * fakechroot_expand_path_at (struct fakechroot_path *, int, const char *);
+void fakechroot_trace (unsigned long *, const char *, const char *, const char *, struct fakechroot_path *);
+unsigned long long fakechroot_stats_now (void);
+int fakechroot_stats_enter (const char *);
+void fakechroot_stats_translate (int, unsigned long long, int);
+void fakechroot_stats_nextcall (const char *);
+void fakechroot_stats_leave (int);
+void * fakechroot_scratch_acquire (void);
+void fakechroot_scratch_release (void *);
+int fakechroot_scratch_depth (void);
+int fakechroot_scratch_reset (int);
+
+#ifdef __GNUC__
+static inline void fakechroot_stats_cleanup (int * frame)
+{
+    if (unlikely(*frame))
+        fakechroot_stats_leave(*frame);
+}
+
+static inline void fakechroot_scratch_cleanup (void * p)
+{
+    fakechroot_scratch_release(*(void **)p);
+}
+#endif
+
+/* Pairs with the release store in fakechroot_loadfunc() and fakechroot_loadfuncs() */
+static inline fakechroot_wrapperfn_t fakechroot_nextfunc (struct fakechroot_wrapper * w)
+{
+    fakechroot_wrapperfn_t nextfunc = __atomic_load_n(&w->nextfunc, __ATOMIC_ACQUIRE);
+    return likely(nextfunc != NULL) ? nextfunc : fakechroot_loadfunc(w);
+}
 
 
 /* We don't want to define _BSD_SOURCE and _DEFAULT_SOURCE and include stdio.h */
@@ -25,9 +25,8 @@
 
 wrapper(link, int, (const char *oldpath, const char *newpath))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char tmp[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    fakechroot_buf_decl(tmp);
     debug("link(\"%s\", \"%s\")", oldpath, newpath);
     expand_chroot_path(oldpath);
     strcpy(tmp, oldpath);
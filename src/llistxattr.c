@@ -29,8 +29,7 @@
 
 wrapper(llistxattr, ssize_t, (const char *path, char *list, size_t size))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("llistxattr(\"%s\", &list, %zd)", path, list);
     expand_chroot_path(path);
     return nextcall(llistxattr)(path, list, size);
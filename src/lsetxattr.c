@@ -28,8 +28,7 @@
 
 wrapper(lsetxattr, int, (const char * path, const char * name, const void * value, size_t size, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("lsetxattr(\"%s\", \"%s\", &value, %zd, %d)", path, name, size, flags);
     expand_chroot_path(path);
     return nextcall(lsetxattr)(path, name, value, size, flags);
@@ -24,47 +24,59 @@
 
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include "libfakechroot.h"
+#include "fstatat.h"
 #include "lstat.h"
+#include "symlink_cache.h"
+#include "rawcall.h"
 
 
 wrapper(lstat, int, (const char * filename, struct stat * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    fakechroot_buf_decl(abs_filename);
     debug("lstat(\"%s\", &buf)", filename);
 
     if (!fakechroot_localdir(filename)) {
         if (filename != NULL) {
-            char abs_filename[FAKECHROOT_PATH_MAX];
             rel2abs(filename, abs_filename);
             filename = abs_filename;
         }
     }
+    expand_chroot_rel_path(filename);
 
-    return lstat_rel(filename, buf);
+    return lstat_translated(fakechroot_path, filename, buf);
 }
 
 
-/* Prevent looping with realpath() */
-LOCAL int lstat_rel(const char * file_name, struct stat * buf)
+/* The path is already translated, see readlink_translated() */
+LOCAL int lstat_translated(struct fakechroot_path * fakechroot_path, const char * file_name, struct stat * buf)
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char *fakechroot_path;
-    char tmp[FAKECHROOT_PATH_MAX];
+    const char *relpath;
+    struct symlink_cache_key key;
     int retval;
-    READLINK_TYPE_RETURN status;
-    const char *orig;
+    ssize_t status;
 
-    debug("lstat_rel(\"%s\", &buf)", file_name);
-    orig = file_name;
-    expand_chroot_rel_path(file_name);
-    retval = nextcall(lstat)(file_name, buf);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        retval = rawcall(fstatat)(fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+        retval = rawcall(fstatat)(AT_FDCWD, file_name, buf, AT_SYMLINK_NOFOLLOW);
+#else
+#ifdef HAVE_FSTATAT
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        retval = nextcall(fstatat)(fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+#endif
+        retval = nextcall(lstat)(file_name, buf);
+#endif
     /* deal with http://bugs.debian.org/561991 */
-    if ((buf->st_mode & S_IFMT) == S_IFLNK)
-        if ((status = readlink(orig, tmp, sizeof(tmp)-1)) != -1)
+    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK) {
+        symlink_cache_key_init(&key, buf);
+        if ((status = symlink_cache_size(fakechroot_path, file_name, &key)) != -1)
             buf->st_size = status;
+    }
     return retval;
 }
 
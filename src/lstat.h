@@ -28,7 +28,7 @@
 
 wrapper_proto(lstat, int, (const char *, struct stat *));
 
-int lstat_rel(const char *, struct stat *);
+int lstat_translated(struct fakechroot_path *, const char *, struct stat *);
 
 #endif
 
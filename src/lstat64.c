@@ -31,18 +31,20 @@
 #include <unistd.h>
 
 #include "libfakechroot.h"
+#include "symlink_cache.h"
+#include "rawcall.h"
 
 
 wrapper(lstat64, int, (const char * file_name, struct stat64 * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char *fakechroot_path;
-    char tmp[FAKECHROOT_PATH_MAX];
-    char resolved[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+#ifdef HAVE_RAW_SYSCALLS
+    const char *relpath;
+#endif
+    struct symlink_cache_key key;
+    fakechroot_buf_decl(resolved);
     int retval;
-    READLINK_TYPE_RETURN status;
-    const char *orig;
+    ssize_t status;
 
     debug("lstat64(\"%s\", &buf)", file_name);
 
@@ -52,13 +54,21 @@ wrapper(lstat64, int, (const char * file_name, struct stat64 * buf))
 
     file_name = resolved;
 
-    orig = file_name;
     expand_chroot_path(file_name);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        retval = rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, AT_SYMLINK_NOFOLLOW);
+    else
+        retval = rawcall(fstatat64)(AT_FDCWD, file_name, buf, AT_SYMLINK_NOFOLLOW);
+#else
     retval = nextcall(lstat64)(file_name, buf);
+#endif
     /* deal with http://bugs.debian.org/561991 */
-    if ((buf->st_mode & S_IFMT) == S_IFLNK)
-        if ((status = readlink(orig, tmp, sizeof(tmp)-1)) != -1)
+    if ((retval == 0) && (buf->st_mode & S_IFMT) == S_IFLNK) {
+        symlink_cache_key_init(&key, buf);
+        if ((status = symlink_cache_size(fakechroot_path, file_name, &key)) != -1)
             buf->st_size = status;
+    }
     return retval;
 }
 
@@ -28,8 +28,7 @@
 
 wrapper(lutimes, int, (const char * filename, const struct timeval tv [2]))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("lutimes(\"%s\", &tv)", filename);
     expand_chroot_path(filename);
     return nextcall(lutimes)(filename, tv);
@@ -23,13 +23,18 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include "libfakechroot.h"
+#include "mkdirat.h"
 
 
 wrapper(mkdir, int, (const char *pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("mkdir(\"%s\", 0%o)", pathname, mode);
     expand_chroot_path(pathname);
+#ifdef HAVE_MKDIRAT
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(mkdirat)(fakechroot_base_fd, relpath, mode);
+#endif
     return nextcall(mkdir)(pathname, mode);
 }
@@ -31,10 +31,12 @@
 
 wrapper(mkdirat, int, (int dirfd, const char * pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("mkdirat(%d, \"%s\", 0%o)", dirfd, pathname, mode);
     expand_chroot_path_at(dirfd, pathname);
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(mkdirat)(fakechroot_base_fd, relpath, mode);
     return nextcall(mkdirat)(dirfd, pathname, mode);
 }
 
@@ -32,9 +32,9 @@
 
 wrapper(mkdtemp, char *, (char * template))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr = tmp;
+    fakechroot_path_decl();
+    fakechroot_buf_decl(tmp);
+    char *tmpptr = tmp;
     char *xxxsrc, *xxxdst;
     int xxxlen = 0;
 
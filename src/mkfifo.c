@@ -27,8 +27,7 @@
 
 wrapper(mkfifo, int, (const char * pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("mkfifo(\"%s\", 0%o)", pathname, mode);
     expand_chroot_path(pathname);
     return nextcall(mkfifo)(pathname, mode);
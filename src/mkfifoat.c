@@ -31,8 +31,7 @@
 
 wrapper(mkfifoat, int, (int dirfd, const char * pathname, mode_t mode))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("mkfifoat(%d, \"%s\", 0%o)", dirfd, pathname, mode);
     expand_chroot_path_at(dirfd, pathname);
     return nextcall(mkfifoat)(dirfd, pathname, mode);
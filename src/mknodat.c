@@ -29,8 +29,7 @@
 
 wrapper(mknodat, int, (int dirfd, const char * pathname, mode_t mode, dev_t dev))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("mknodat(%d, \"%s\", 0%o, %ld)", dirfd, pathname, mode, dev);
     expand_chroot_path_at(dirfd, pathname);
     return nextcall(mknodat)(dirfd, pathname, mode, dev);
@@ -31,12 +31,12 @@
 
 wrapper(mkostemp, int, (char * template, int flags))
 {
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr = tmp;
+    fakechroot_buf_decl(tmp);
+    char *tmpptr = tmp;
     char *xxxsrc, *xxxdst;
     int xxxlen = 0;
     int fd;
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
     debug("mkostemp(\"%s\", %d)", template, flags);
 
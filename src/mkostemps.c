@@ -32,12 +32,12 @@
 
 wrapper(mkostemps, int, (char * template, int suffixlen, int flags))
 {
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr = tmp;
+    fakechroot_buf_decl(tmp);
+    char *tmpptr = tmp;
     char *xxxsrc, *xxxdst;
     int xxxlen = 0;
     int fd;
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
     debug("mkostemps(\"%s\", %d, %d)", template, suffixlen, flags);
 
@@ -33,12 +33,12 @@
 
 wrapper(mkostemps64, int, (char * template, int suffixlen, int flags))
 {
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr = tmp;
+    fakechroot_buf_decl(tmp);
+    char *tmpptr = tmp;
     char *xxxsrc, *xxxdst;
     int xxxlen = 0;
     int fd;
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
 
     debug("mkostemps64(\"%s\", %d, %d)", template, suffixlen, flags);
 
@@ -24,12 +24,16 @@
 #include <stddef.h>
 #include <fcntl.h>
 #include "libfakechroot.h"
+#include "openat.h"
+#include "fd_path.h"
+#include "rawcall.h"
 
 
 wrapper_alias(open, int, (const char * pathname, int flags, ...))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
 
     int mode = 0;
 
@@ -44,5 +48,19 @@ wrapper_alias(open, int, (const char * pathname, int flags, ...))
         va_end(arg);
     }
 
-    return nextcall(open)(pathname, flags, mode);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = rawcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = rawcall(openat)(AT_FDCWD, pathname, flags, mode);
+#else
+#ifdef HAVE_OPENAT
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+#endif
+        fd = nextcall(open)(pathname, flags, mode);
+#endif
+    fd_path_register(fd, fakechroot_path, AT_FDCWD, pathname);
+    return fd;
 }
@@ -27,12 +27,15 @@
 #include <stddef.h>
 #include <fcntl.h>
 #include "libfakechroot.h"
+#include "fd_path.h"
+#include "rawcall.h"
 
 
 wrapper_alias(openat, int, (int dirfd, const char * pathname, int flags, ...))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
 
     int mode = 0;
 
@@ -47,7 +50,19 @@ wrapper_alias(openat, int, (int dirfd, const char * pathname, int flags, ...))
         va_end(arg);
     }
 
-    return nextcall(openat)(dirfd, pathname, flags, mode);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = rawcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = rawcall(openat)(dirfd, pathname, flags, mode);
+#else
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = nextcall(openat)(dirfd, pathname, flags, mode);
+#endif
+    fd_path_register(fd, fakechroot_path, dirfd, pathname);
+    return fd;
 }
 
 #else
@@ -28,12 +28,15 @@
 #include <stddef.h>
 #include <fcntl.h>
 #include "libfakechroot.h"
+#include "fd_path.h"
+#include "rawcall.h"
 
 
 wrapper_alias(openat64, int, (int dirfd, const char * pathname, int flags, ...))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+    int fd;
 
     int mode = 0;
 
@@ -48,7 +51,19 @@ wrapper_alias(openat64, int, (int dirfd, const char * pathname, int flags, ...))
         va_end(arg);
     }
 
-    return nextcall(openat64)(dirfd, pathname, flags, mode);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = rawcall(openat64)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = rawcall(openat64)(dirfd, pathname, flags, mode);
+#else
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        fd = nextcall(openat64)(fakechroot_base_fd, relpath, flags, mode);
+    else
+        fd = nextcall(openat64)(dirfd, pathname, flags, mode);
+#endif
+    fd_path_register(fd, fakechroot_path, dirfd, pathname);
+    return fd;
 }
 
 #else
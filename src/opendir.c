@@ -22,17 +22,25 @@
 
 #if !defined(OPENDIR_CALLS___OPEN) && !defined(OPENDIR_CALLS___OPENDIR2)
 
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include "libfakechroot.h"
+#include "fd_path.h"
 
 
 wrapper(opendir, DIR *, (const char * name))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    DIR *dirp;
     debug("opendir(\"%s\")", name);
     expand_chroot_path(name);
-    return nextcall(opendir)(name);
+    if ((dirp = nextcall(opendir)(name)) != NULL) {
+        fd_path_register(dirfd(dirp), fakechroot_path, AT_FDCWD, name);
+    }
+    return dirp;
 }
 
 #else
@@ -0,0 +1,209 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "libfakechroot.h"
+#include "path_cache.h"
+#include "strchrnul.h"
+
+
+/*
+ * Cache of the PATH searches of execvp(), execlp() and posix_spawnp().
+ *
+ * An entry maps the command name and the value of PATH to the position of
+ * the directory in PATH where the command was found.  It also keeps the
+ * modification time of this directory and of all the directories before
+ * it, so the entry is trusted only if none of them has changed: a command
+ * added to an earlier directory or removed from the found one changes the
+ * mtime of that directory.  A hit costs a stat() of these directories
+ * instead of an execve() attempt in each of them.  A directory changed in
+ * the last second is not trusted as its next change could keep the same
+ * coarse mtime.
+ *
+ * execvp() stores the entry before its execve() attempt, so it checks first
+ * that the directory has the file.
+ *
+ * Searches which go through a relative directory depend on the current
+ * directory and are not cached.  The entries are guarded by a sequence
+ * counter, the same as in exec_plan.c, because a vfork() child stores the
+ * command it is going to exec in the memory of its parent.
+ */
+
+#define PATH_CACHE_ENTRIES 32
+#define PATH_CACHE_NAME_MAX 64
+#define PATH_CACHE_LOCK_TRIES 1000
+#define PATH_CACHE_READ_TRIES 4
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+struct path_cache_entry {
+    unsigned long seq;
+    unsigned long long path_hash;
+    size_t path_len;
+    unsigned int ndirs;
+    char name[PATH_CACHE_NAME_MAX];
+    struct path_cache_dir dirs[PATH_CACHE_DIRS];
+};
+
+static struct path_cache_entry path_cache_table[PATH_CACHE_ENTRIES];
+
+
+static unsigned long long path_cache_hash(unsigned long long h, const char *s, size_t len)
+{
+    while (len--) {
+        h ^= (unsigned char)*s++;
+        h *= FNV64_PRIME;
+    }
+    return h;
+}
+
+
+static struct path_cache_entry * path_cache_entry(const struct path_cache_search *search, const char *file)
+{
+    unsigned long long h = path_cache_hash(search->path_hash, file, strlen(file));
+    return &path_cache_table[(h >> 32) % PATH_CACHE_ENTRIES];
+}
+
+
+/* Check the state of the directory */
+static void path_cache_stat(struct path_cache_dir *dir, const char *path, size_t len)
+{
+    fakechroot_buf_decl(buf);
+    struct stat st;
+
+    memcpy(buf, path, len);
+    buf[len] = '\0';
+
+    memset(dir, 0, sizeof(*dir));
+    if (stat(buf, &st) == 0) {
+        dir->exists = 1;
+        dir->mtime_sec = st.st_mtim.tv_sec;
+        dir->mtime_nsec = st.st_mtim.tv_nsec;
+    }
+}
+
+
+/*
+ * Start the search of the file in path.  Return the index of the element
+ * of path where the file was found before or -1.
+ */
+LOCAL int path_cache_lookup(struct path_cache_search *search, const char *path, const char *file)
+{
+    struct path_cache_entry *entry;
+    struct path_cache_dir dirs[PATH_CACHE_DIRS], dir;
+    const char *p, *end;
+    unsigned long seq;
+    unsigned int ndirs, i;
+    int tries;
+
+    search->path_len = strlen(path);
+    search->path_hash = path_cache_hash(FNV64_OFFSET_BASIS, path, search->path_len);
+    search->now = time(NULL);
+    search->ndirs = 0;
+    search->cacheable = strlen(file) < PATH_CACHE_NAME_MAX;
+
+    if (!search->cacheable)
+        return -1;
+
+    entry = path_cache_entry(search, file);
+    for (tries = 0; ; tries++) {
+        if (tries == PATH_CACHE_READ_TRIES)
+            return -1;
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1))
+            return -1;
+        if (entry->path_hash != search->path_hash || entry->path_len != search->path_len || strncmp(entry->name, file, PATH_CACHE_NAME_MAX) != 0)
+            return -1;
+        ndirs = entry->ndirs;
+        if (ndirs == 0 || ndirs > PATH_CACHE_DIRS)
+            return -1;
+        memcpy(dirs, entry->dirs, ndirs * sizeof(struct path_cache_dir));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq)
+            break;
+    }
+
+    /* The directories up to the found one must be unchanged */
+    for (i = 0, p = path; i < ndirs; i++, p = end + 1) {
+        end = strchrnul(p, ':');
+        path_cache_stat(&dir, p, end - p);
+        if (dir.exists != dirs[i].exists || dir.mtime_sec != dirs[i].mtime_sec || dir.mtime_nsec != dirs[i].mtime_nsec)
+            return -1;
+        if (*end == '\0' && i + 1 < ndirs)
+            return -1;
+    }
+
+    debug("path_cache_lookup(\"%s\"): element %u", file, ndirs - 1);
+    return ndirs - 1;
+}
+
+
+/* Record the next directory of the search before the file is tried there */
+LOCAL void path_cache_dir(struct path_cache_search *search, const char *dir, size_t len)
+{
+    if (!search->cacheable)
+        return;
+    if (search->ndirs == PATH_CACHE_DIRS || len == 0 || *dir != '/') {
+        search->cacheable = 0;
+        return;
+    }
+    path_cache_stat(&search->dirs[search->ndirs], dir, len);
+    if (search->dirs[search->ndirs].exists && search->dirs[search->ndirs].mtime_sec >= search->now - 1) {
+        search->cacheable = 0;
+        return;
+    }
+    search->ndirs++;
+}
+
+
+/* Remember that the file is in the last recorded directory */
+LOCAL void path_cache_store(struct path_cache_search *search, const char *file)
+{
+    struct path_cache_entry *entry;
+    unsigned long seq;
+    int i;
+
+    if (!search->cacheable || search->ndirs == 0)
+        return;
+
+    entry = path_cache_entry(search, file);
+    for (i = 0; ; i++) {
+        if (i == PATH_CACHE_LOCK_TRIES)
+            return;
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(&entry->seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    entry->path_hash = search->path_hash;
+    entry->path_len = search->path_len;
+    entry->ndirs = search->ndirs;
+    strncpy(entry->name, file, PATH_CACHE_NAME_MAX);
+    memcpy(entry->dirs, search->dirs, search->ndirs * sizeof(struct path_cache_dir));
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
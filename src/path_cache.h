@@ -0,0 +1,48 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __PATH_CACHE_H
+#define __PATH_CACHE_H
+
+#include <stddef.h>
+
+/* Longer searches are not cached */
+#define PATH_CACHE_DIRS 32
+
+struct path_cache_dir {
+    long long mtime_sec;
+    long mtime_nsec;
+    int exists;
+};
+
+/* State of one search of PATH */
+struct path_cache_search {
+    unsigned long long path_hash;
+    size_t path_len;
+    long long now;
+    unsigned int ndirs;
+    int cacheable;
+    struct path_cache_dir dirs[PATH_CACHE_DIRS];
+};
+
+int path_cache_lookup(struct path_cache_search *, const char *, const char *);
+void path_cache_dir(struct path_cache_search *, const char *, size_t);
+void path_cache_store(struct path_cache_search *, const char *);
+
+#endif
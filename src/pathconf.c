@@ -25,8 +25,7 @@
 
 wrapper(pathconf, long, (const char * path, int name))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("pathconf(\"%s\", %d)", path, name);
     expand_chroot_path(path);
     return nextcall(pathconf)(path, name);
@@ -34,16 +34,19 @@
 
 #include <config.h>
 
-#ifdef __GNUC__
+#if defined(__GNUC__) && defined(HAVE_POSIX_SPAWN)
 
 #define _BSD_SOURCE
 #define _POSIX_SOURCE
 #define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #include <sys/param.h>
 #include <sys/wait.h>
 
-#include <signal.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -52,8 +55,13 @@
 
 #include "libfakechroot.h"
 
-#define _MUTEX_LOCK(a)
-#define _MUTEX_UNLOCK(a)
+/*
+ * The command is started with posix_spawn() of this library, so the shell
+ * is translated and run by the ELF loader like for any other exec.  Both
+ * ends of the pipe are close-on-exec: the child gets its end by a dup2()
+ * file action and the streams of the other popen() calls are closed in the
+ * children without walking the list.
+ */
 
 static struct pid {
         struct pid *next;
@@ -61,17 +69,32 @@ static struct pid {
         pid_t pid;
 } *pidlist;
 
+static pthread_mutex_t pidlist_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
-#if 0
-static void *pidlist_lock = NULL;
+static int
+popen_pipe(int pdes[2])
+{
+#ifdef HAVE_PIPE2
+        return pipe2(pdes, O_CLOEXEC);
+#else
+        if (pipe(pdes) < 0)
+                return -1;
+        (void)fcntl(pdes[0], F_SETFD, FD_CLOEXEC);
+        (void)fcntl(pdes[1], F_SETFD, FD_CLOEXEC);
+        return 0;
 #endif
+}
+
 
 FILE *
 popen(const char *program, const char *type)
 {
-        struct pid * volatile cur;
+        struct pid *cur;
         FILE *iop;
-        int pdes[2];
+        int pdes[2], parent, child, target, status;
+        char *argv[] = { "sh", "-c", (char *)program, NULL };
+        posix_spawn_file_actions_t actions;
         pid_t pid;
 
         debug("popen(\"%s\", \"%s\")", program, type);
@@ -84,74 +107,52 @@ popen(const char *program, const char *type)
         if ((cur = malloc(sizeof(struct pid))) == NULL)
                 return (NULL);
 
-        if (pipe(pdes) < 0) {
+        if (popen_pipe(pdes) < 0) {
                 free(cur);
                 return (NULL);
         }
 
-        _MUTEX_LOCK(&pidlist_lock);
-        switch (pid = vfork()) {
-        case -1:                        /* Error. */
-                _MUTEX_UNLOCK(&pidlist_lock);
-                (void)close(pdes[0]);
-                (void)close(pdes[1]);
+        if (*type == 'r') {
+                parent = pdes[0];
+                child = pdes[1];
+                target = STDOUT_FILENO;
+        } else {
+                parent = pdes[1];
+                child = pdes[0];
+                target = STDIN_FILENO;
+        }
+
+        /* dup2() to the same descriptor would keep close-on-exec */
+        if (child == target)
+                (void)fcntl(child, F_SETFD, 0);
+
+        if ((status = posix_spawn_file_actions_init(&actions)) == 0) {
+                if (child != target)
+                        status = posix_spawn_file_actions_adddup2(&actions, child, target);
+                if (status == 0)
+                        status = posix_spawn(&pid, _PATH_BSHELL, &actions, NULL, argv, environ);
+                posix_spawn_file_actions_destroy(&actions);
+        }
+
+        (void)close(child);
+
+        if (status != 0) {
+                (void)close(parent);
                 free(cur);
+                errno = status;
                 return (NULL);
-                /* NOTREACHED */
-        case 0:                         /* Child. */
-            {
-                struct pid *pcur;
-                /*
-                 * because vfork() instead of fork(), must leak FILE *,
-                 * but luckily we are terminally headed for an execl()
-                 */
-                for (pcur = pidlist; pcur; pcur = pcur->next)
-                        close(fileno(pcur->fp));
-
-                if (*type == 'r') {
-                        int tpdes1 = pdes[1];
-
-                        (void) close(pdes[0]);
-                        /*
-                         * We must NOT modify pdes, due to the
-                         * semantics of vfork.
-                         */
-                        if (tpdes1 != STDOUT_FILENO) {
-                                (void)dup2(tpdes1, STDOUT_FILENO);
-                                (void)close(tpdes1);
-                                tpdes1 = STDOUT_FILENO;
-                        }
-                } else {
-                        (void)close(pdes[1]);
-                        if (pdes[0] != STDIN_FILENO) {
-                                (void)dup2(pdes[0], STDIN_FILENO);
-                                (void)close(pdes[0]);
-                        }
-                }
-                execl(_PATH_BSHELL, "sh", "-c", program, (char *)NULL);
-                _exit(127);
-                /* NOTREACHED */
-            }
-                break;
         }
-        _MUTEX_UNLOCK(&pidlist_lock);
 
         /* Parent; assume fdopen can't fail. */
-        if (*type == 'r') {
-                iop = fdopen(pdes[0], type);
-                (void)close(pdes[1]);
-        } else {
-                iop = fdopen(pdes[1], type);
-                (void)close(pdes[0]);
-        }
+        iop = fdopen(parent, type);
 
         /* Link into list of file descriptors. */
         cur->fp = iop;
-        cur->pid =  pid;
-        _MUTEX_LOCK(&pidlist_lock);
+        cur->pid = pid;
+        pthread_mutex_lock(&pidlist_lock);
         cur->next = pidlist;
         pidlist = cur;
-        _MUTEX_UNLOCK(&pidlist_lock);
+        pthread_mutex_unlock(&pidlist_lock);
 
         return (iop);
 }
@@ -168,16 +169,16 @@ pclose(FILE *iop)
         int pstat;
         pid_t pid;
 
-        debug("popen(iop)");
+        debug("pclose(iop)");
 
         /* Find the appropriate file pointer. */
-        _MUTEX_LOCK(&pidlist_lock);
+        pthread_mutex_lock(&pidlist_lock);
         for (last = NULL, cur = pidlist; cur; last = cur, cur = cur->next)
                 if (cur->fp == iop)
                         break;
 
         if (cur == NULL) {
-                _MUTEX_UNLOCK(&pidlist_lock);
+                pthread_mutex_unlock(&pidlist_lock);
                 return (-1);
         }
 
@@ -186,7 +187,7 @@ pclose(FILE *iop)
                 pidlist = cur->next;
         else
                 last->next = cur->next;
-        _MUTEX_UNLOCK(&pidlist_lock);
+        pthread_mutex_unlock(&pidlist_lock);
 
         (void)fclose(iop);
 
@@ -31,6 +31,7 @@
 #include <alloca.h>
 #include "strchrnul.h"
 #include "libfakechroot.h"
+#include "path_cache.h"
 
 #define DEFAULT_PATH ":/usr/bin:/bin"
 
@@ -58,7 +59,9 @@ wrapper(posix_spawnp, int, (pid_t* pid, const char* file,
         return posix_spawn(pid, file, file_actions, attrp, argv, envp);
     } else {
         int got_eacces = 0;
-        char *path, *p, *name;
+        char *path, *p, *name, *end;
+        struct path_cache_search search;
+        int cached, status;
         size_t len;
         size_t pathlen;
 
@@ -86,6 +89,29 @@ wrapper(posix_spawnp, int, (pid_t* pid, const char* file,
         /* And add the slash.  */
         *--name = '/';
 
+        /* Try the directory where the file was found before */
+        if ((cached = path_cache_lookup(&search, path, file)) >= 0) {
+            char *startp;
+
+            for (p = path; cached-- > 0; p = strchrnul(p, ':') + 1);
+            end = strchrnul(p, ':');
+            startp = (char *) memcpy(name - (end - p), p, end - p);
+            if ((status = posix_spawn(pid, startp, file_actions, attrp, argv, envp)) == 0)
+                return 0;
+            __set_errno(status);
+
+            switch (errno) {
+            case EACCES:
+            case ENOENT:
+            case ESTALE:
+            case ENOTDIR:
+                /* Search again */
+                break;
+            default:
+                return errno;
+            }
+        }
+
         p = path;
         do {
             char *startp;
@@ -101,8 +127,13 @@ wrapper(posix_spawnp, int, (pid_t* pid, const char* file,
                 startp = (char *) memcpy(name - (p - path), path, p - path);
 
             /* Try to execute this name.  If it works, return.  */
-            if (!posix_spawn(pid, startp, file_actions, attrp, argv, envp))
+            path_cache_dir(&search, path, p - path);
+            if ((status = posix_spawn(pid, startp, file_actions, attrp, argv, envp)) == 0) {
+                path_cache_store(&search, file);
                 return 0;
+            }
+            /* The error is returned rather than set in errno */
+            __set_errno(status);
 
             switch (errno) {
             case EACCES:
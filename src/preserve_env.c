@@ -0,0 +1,109 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+#include <string.h>
+#include "strchrnul.h"
+
+#include "libfakechroot.h"
+#include "preserve_env.h"
+
+
+/*
+ * Set of the environment variables which are kept by clearenv() and added
+ * to the environment of a new program if the caller has dropped them.
+ *
+ * An environment is matched against the set in a single pass: most of the
+ * variables are rejected by their first character, the rest by the length
+ * of the name before the names are compared.  The result is a bit mask
+ * indexed by the position in preserve_env_list.
+ */
+
+/* List of environment variables to preserve on clearenv() */
+char *preserve_env_list[] = {
+    "FAKECHROOT_BASE_FD",
+    "FAKECHROOT_DEBUG",
+    "FAKEROOTKEY",
+    "FAKED_MODE",
+    "LD_LIBRARY_PATH",
+    "LD_PRELOAD"
+};
+const int preserve_env_list_count = sizeof preserve_env_list / sizeof preserve_env_list[0];
+
+#define PRESERVE_ENV_COUNT (sizeof preserve_env_list / sizeof preserve_env_list[0])
+
+/* The result has to fit in the mask */
+typedef char preserve_env_count_check[PRESERVE_ENV_COUNT <= 8 * sizeof(unsigned int) ? 1 : -1];
+
+static size_t preserve_env_len[PRESERVE_ENV_COUNT];
+/* Entries which start with the character */
+static unsigned int preserve_env_first[256];
+static int preserve_env_ready = 0;
+
+
+LOCAL void preserve_env_init(void)
+{
+    size_t j;
+
+    for (j = 0; j < PRESERVE_ENV_COUNT; j++) {
+        preserve_env_len[j] = strlen(preserve_env_list[j]);
+        preserve_env_first[(unsigned char)preserve_env_list[j][0]] |= 1U << j;
+    }
+    __atomic_store_n(&preserve_env_ready, 1, __ATOMIC_RELEASE);
+}
+
+
+/*
+ * Find the preserved variables in envp.  If values is not NULL, values[j]
+ * points to the value of the first definition of preserve_env_list[j], the
+ * same as getenv() would return.  Returns the mask of found variables.
+ */
+LOCAL unsigned int preserve_env_scan(char * const envp[], const char *values[])
+{
+    unsigned int found = 0, candidates;
+    char * const *ep;
+    size_t len;
+    int j;
+
+    if (!__atomic_load_n(&preserve_env_ready, __ATOMIC_ACQUIRE))
+        preserve_env_init();
+
+    if (envp == NULL)
+        return 0;
+
+    for (ep = envp; *ep != NULL; ep++) {
+        if ((candidates = preserve_env_first[(unsigned char)**ep] & ~found) == 0)
+            continue;
+        len = strchrnul(*ep, '=') - *ep;
+        if ((*ep)[len] != '=')
+            continue;
+        for (j = 0; candidates != 0; j++, candidates >>= 1) {
+            if ((candidates & 1) && preserve_env_len[j] == len && memcmp(*ep, preserve_env_list[j], len) == 0) {
+                found |= 1U << j;
+                if (values != NULL)
+                    values[j] = *ep + len + 1;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,96 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#define _LARGEFILE64_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <string.h>
+#include <fcntl.h>
+
+#include "libfakechroot.h"
+#include "rawcall.h"
+
+#if defined(HAVE_RAW_SYSCALLS) && !defined(RAW_STAT_NEWFSTATAT)
+
+/*
+ * Build struct stat from statx(2) like the C library does on the
+ * architectures where the kernel struct stat has another layout.  The
+ * fields which don't fit are reported with EOVERFLOW.
+ */
+#define raw_stat_from_statx(st, stx) \
+    do { \
+        memset((st), 0, sizeof(*(st))); \
+        (st)->st_dev = makedev((stx).stx_dev_major, (stx).stx_dev_minor); \
+        (st)->st_ino = (stx).stx_ino; \
+        (st)->st_mode = (stx).stx_mode; \
+        (st)->st_nlink = (stx).stx_nlink; \
+        (st)->st_uid = (stx).stx_uid; \
+        (st)->st_gid = (stx).stx_gid; \
+        (st)->st_rdev = makedev((stx).stx_rdev_major, (stx).stx_rdev_minor); \
+        (st)->st_size = (stx).stx_size; \
+        (st)->st_blksize = (stx).stx_blksize; \
+        (st)->st_blocks = (stx).stx_blocks; \
+        (st)->st_atim.tv_sec = (stx).stx_atime.tv_sec; \
+        (st)->st_atim.tv_nsec = (stx).stx_atime.tv_nsec; \
+        (st)->st_mtim.tv_sec = (stx).stx_mtime.tv_sec; \
+        (st)->st_mtim.tv_nsec = (stx).stx_mtime.tv_nsec; \
+        (st)->st_ctim.tv_sec = (stx).stx_ctime.tv_sec; \
+        (st)->st_ctim.tv_nsec = (stx).stx_ctime.tv_nsec; \
+        if ((unsigned long long)(st)->st_ino != (stx).stx_ino || \
+            (unsigned long long)(st)->st_size != (stx).stx_size || \
+            (unsigned long long)(st)->st_blocks != (stx).stx_blocks || \
+            (long long)(st)->st_atim.tv_sec != (stx).stx_atime.tv_sec || \
+            (long long)(st)->st_mtim.tv_sec != (stx).stx_mtime.tv_sec || \
+            (long long)(st)->st_ctim.tv_sec != (stx).stx_ctime.tv_sec) { \
+            errno = EOVERFLOW; \
+            return -1; \
+        } \
+    } while (0)
+
+
+LOCAL int raw_fstatat (int dirfd, const char * path, void * buf, int flags)
+{
+    struct stat *st = buf;
+    struct statx stx;
+
+    if (raw_statx(dirfd, path, flags | AT_NO_AUTOMOUNT, STATX_BASIC_STATS, &stx) != 0)
+        return -1;
+    raw_stat_from_statx(st, stx);
+    return 0;
+}
+
+
+LOCAL int raw_fstatat64 (int dirfd, const char * path, void * buf, int flags)
+{
+    struct stat64 *st = buf;
+    struct statx stx;
+
+    if (raw_statx(dirfd, path, flags | AT_NO_AUTOMOUNT, STATX_BASIC_STATS, &stx) != 0)
+        return -1;
+    raw_stat_from_statx(st, stx);
+    return 0;
+}
+
+#else
+typedef int empty_translation_unit;
+#endif
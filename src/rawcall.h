@@ -0,0 +1,112 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __RAWCALL_H
+#define __RAWCALL_H
+
+/*
+ * Raw system call backend, enabled with --enable-raw-syscalls.
+ *
+ * The hottest wrappers call the *at() system calls directly with the
+ * translated path instead of going through the next function, which is
+ * usually a chain of the C library compatibility shims.  The kernel struct
+ * stat is used as is on the 64-bit architectures where it is the same as
+ * the C library one; elsewhere stat is built from statx(2).
+ */
+
+#if defined(USE_RAW_SYSCALLS) && defined(HAVE_SYS_SYSCALL_H)
+# include <sys/syscall.h>
+# if defined(SYS_openat) && defined(SYS_readlinkat) && defined(SYS_faccessat)
+#  if defined(SYS_newfstatat) && defined(__LP64__) && \
+      (defined(__x86_64__) || defined(__aarch64__) || (defined(__riscv) && __riscv_xlen == 64))
+#   define HAVE_RAW_SYSCALLS 1
+#   define RAW_STAT_NEWFSTATAT 1
+#  elif defined(SYS_statx)
+#   define HAVE_RAW_SYSCALLS 1
+#  endif
+# endif
+#endif
+
+#ifdef HAVE_RAW_SYSCALLS
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include "libfakechroot.h"
+
+/* We don't want to define _DEFAULT_SOURCE in every wrapper */
+long syscall (long, ...);
+
+#define rawcall(function) \
+    ( \
+      (unlikely(fakechroot_stats_enabled) ? fakechroot_stats_nextcall(__func__) : (void)0), \
+      raw_##function \
+    )
+
+static inline int raw_openat (int dirfd, const char * path, int flags, int mode)
+{
+    return syscall(SYS_openat, dirfd, path, flags, mode);
+}
+
+static inline int raw_openat64 (int dirfd, const char * path, int flags, int mode)
+{
+#ifdef O_LARGEFILE
+    flags |= O_LARGEFILE;
+#endif
+    return syscall(SYS_openat, dirfd, path, flags, mode);
+}
+
+#ifdef RAW_STAT_NEWFSTATAT
+static inline int raw_fstatat (int dirfd, const char * path, void * buf, int flags)
+{
+    return syscall(SYS_newfstatat, dirfd, path, buf, flags);
+}
+# define raw_fstatat64 raw_fstatat
+#else
+int raw_fstatat (int, const char *, void *, int);
+int raw_fstatat64 (int, const char *, void *, int);
+#endif
+
+#ifdef SYS_statx
+static inline int raw_statx (int dirfd, const char * path, int flags, unsigned int mask, void * buf)
+{
+    return syscall(SYS_statx, dirfd, path, flags, mask, buf);
+}
+#endif
+
+static inline ssize_t raw_readlinkat (int dirfd, const char * path, char * buf, size_t bufsiz)
+{
+    return syscall(SYS_readlinkat, dirfd, path, buf, bufsiz);
+}
+
+/* Fails with ENOSYS if the flags need faccessat2(2) and the kernel is older than 5.8 */
+static inline int raw_faccessat (int dirfd, const char * path, int mode, int flags)
+{
+    if (flags == 0)
+        return syscall(SYS_faccessat, dirfd, path, mode);
+#ifdef SYS_faccessat2
+    return syscall(SYS_faccessat2, dirfd, path, mode, flags);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+#endif
+
+#endif
@@ -23,17 +23,14 @@
 #include <sys/types.h>
 #include <stddef.h>
 #include "libfakechroot.h"
+#include "readlink.h"
+#include "readlinkat.h"
+#include "rawcall.h"
 
 
 wrapper(readlink, READLINK_TYPE_RETURN, (const char * path, char * buf, READLINK_TYPE_ARG3(bufsiz)))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-
-    int linksize;
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr;
-
-    const char *fakechroot_base = getenv("FAKECHROOT_BASE");
+    fakechroot_path_decl();
 
     debug("readlink(\"%s\", &buf, %zd)", path, bufsiz);
     if (!strcmp(path, "/etc/malloc.conf")) {
@@ -42,37 +39,43 @@ wrapper(readlink, READLINK_TYPE_RETURN, (const char * path, char * buf, READLINK
     }
     expand_chroot_path(path);
 
-    if ((linksize = nextcall(readlink)(path, tmp, FAKECHROOT_PATH_MAX-1)) == -1) {
+    return readlink_translated(fakechroot_path, path, buf, bufsiz);
+}
+
+
+/*
+ * The path is already translated, by the caller into fakechroot_path if it
+ * isn't excluded.  Used by the wrappers which need the target of a link
+ * they have just found, so the path is not translated again.
+ */
+LOCAL ssize_t readlink_translated(struct fakechroot_path * fakechroot_path, const char * path, char * buf, size_t bufsiz)
+{
+    const char *relpath;
+    ssize_t linksize;
+    fakechroot_buf_decl(tmp);
+
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(path)) != NULL)
+        linksize = rawcall(readlinkat)(fakechroot_base_fd, relpath, tmp, FAKECHROOT_PATH_MAX-1);
+    else
+        linksize = rawcall(readlinkat)(AT_FDCWD, path, tmp, FAKECHROOT_PATH_MAX-1);
+#else
+#ifdef HAVE_READLINKAT
+    if ((relpath = fakechroot_base_path(path)) != NULL)
+        linksize = nextcall(readlinkat)(fakechroot_base_fd, relpath, tmp, FAKECHROOT_PATH_MAX-1);
+    else
+#endif
+        linksize = nextcall(readlink)(path, tmp, FAKECHROOT_PATH_MAX-1);
+#endif
+    if (linksize == -1) {
         return -1;
     }
     tmp[linksize] = '\0';
 
-    if (fakechroot_base != NULL) {
-        tmpptr = strstr(tmp, fakechroot_base);
-        if (tmpptr != tmp) {
-            tmpptr = tmp;
-        }
-        else if (tmp[strlen(fakechroot_base)] == '\0') {
-            tmpptr = "/";
-            linksize = strlen(tmpptr);
-        }
-        else if (tmp[strlen(fakechroot_base)] == '/') {
-            tmpptr = tmp + strlen(fakechroot_base);
-            linksize -= strlen(fakechroot_base);
-        }
-        else {
-            tmpptr = tmp;
-        }
-        if (strlen(tmpptr) > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmpptr, linksize);
-    }
-    else {
-        if (linksize > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmp, linksize);
+    linksize = narrow_chroot_path(tmp);
+    if (linksize > bufsiz) {
+        linksize = bufsiz;
     }
+    memcpy(buf, tmp, linksize);
     return linksize;
 }
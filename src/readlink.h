@@ -22,8 +22,11 @@
 
 #include <config.h>
 
+#include <sys/types.h>
 #include "libfakechroot.h"
 
 wrapper_proto(readlink, READLINK_TYPE_RETURN, (const char *, char *, READLINK_TYPE_ARG3()));
 
+ssize_t readlink_translated(struct fakechroot_path *, const char *, char *, size_t);
+
 #endif
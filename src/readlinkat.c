@@ -26,51 +26,40 @@
 #include <sys/types.h>
 #include <stddef.h>
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(readlinkat, ssize_t, (int dirfd, const char * path, char * buf, size_t bufsiz))
 {
     int linksize;
-    char tmp[FAKECHROOT_PATH_MAX], *tmpptr;
-    const char *fakechroot_base = getenv("FAKECHROOT_BASE");
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_buf_decl(tmp);
+    fakechroot_path_decl();
+    const char *relpath;
 
     debug("readlinkat(%d, \"%s\", &buf, %zd)", dirfd, path, bufsiz);
     expand_chroot_path_at(dirfd, path);
 
-    if ((linksize = nextcall(readlinkat)(dirfd, path, tmp, FAKECHROOT_PATH_MAX-1)) == -1) {
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(path)) != NULL)
+        linksize = rawcall(readlinkat)(fakechroot_base_fd, relpath, tmp, FAKECHROOT_PATH_MAX-1);
+    else
+        linksize = rawcall(readlinkat)(dirfd, path, tmp, FAKECHROOT_PATH_MAX-1);
+#else
+    if ((relpath = fakechroot_base_path(path)) != NULL)
+        linksize = nextcall(readlinkat)(fakechroot_base_fd, relpath, tmp, FAKECHROOT_PATH_MAX-1);
+    else
+        linksize = nextcall(readlinkat)(dirfd, path, tmp, FAKECHROOT_PATH_MAX-1);
+#endif
+    if (linksize == -1) {
         return -1;
     }
     tmp[linksize] = '\0';
 
-    if (fakechroot_base != NULL) {
-        tmpptr = strstr(tmp, fakechroot_base);
-        if (tmpptr != tmp) {
-            tmpptr = tmp;
-        }
-        else if (tmp[strlen(fakechroot_base)] == '\0') {
-            tmpptr = "/";
-            linksize = strlen(tmpptr);
-        }
-        else if (tmp[strlen(fakechroot_base)] == '/') {
-            tmpptr = tmp + strlen(fakechroot_base);
-            linksize -= strlen(fakechroot_base);
-        }
-        else {
-            tmpptr = tmp;
-        }
-        if (strlen(tmpptr) > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmpptr, linksize);
-    }
-    else {
-        if (linksize > bufsiz) {
-            linksize = bufsiz;
-        }
-        strncpy(buf, tmp, linksize);
+    linksize = narrow_chroot_path(tmp);
+    if (linksize > bufsiz) {
+        linksize = bufsiz;
     }
+    memcpy(buf, tmp, linksize);
     return linksize;
 }
 
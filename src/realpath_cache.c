@@ -0,0 +1,144 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "libfakechroot.h"
+#include "realpath_cache.h"
+
+
+/*
+ * Cache of the resolved directories of realpath().
+ *
+ * The walk of realpath() makes a system call for each component of the
+ * path which it doesn't know to be a directory.  A directory which can't be
+ * replaced by a symlink or a file is remembered by its resolved path, and
+ * the walk goes through it without any system call.  Such directories are
+ * the Nix store with its parents, and the directories of the registered
+ * store paths, which are read-only and have the mtime set to 1 by Nix.
+ *
+ * The table is direct mapped and shared by the threads.  The entries are
+ * guarded by a sequence counter, the same as in path_cache.c.
+ */
+
+#define REALPATH_CACHE_ENTRIES 256
+#define REALPATH_CACHE_PATH_MAX 256
+#define REALPATH_CACHE_LOCK_TRIES 1000
+#define REALPATH_CACHE_READ_TRIES 4
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+struct realpath_cache_entry {
+    unsigned long seq;
+    unsigned long long hash;
+    size_t len;
+    char path[REALPATH_CACHE_PATH_MAX];
+};
+
+static struct realpath_cache_entry realpath_cache_table[REALPATH_CACHE_ENTRIES];
+
+
+static struct realpath_cache_entry * realpath_cache_entry(const char *path, size_t len, unsigned long long *hash)
+{
+    unsigned long long h = FNV64_OFFSET_BASIS;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char)path[i];
+        h *= FNV64_PRIME;
+    }
+    *hash = h;
+    return &realpath_cache_table[(h >> 32) % REALPATH_CACHE_ENTRIES];
+}
+
+
+/* Check if the resolved path of len bytes is a directory for good */
+LOCAL int realpath_cache_lookup(const char *path, size_t len)
+{
+    struct realpath_cache_entry *entry;
+    unsigned long long hash;
+    unsigned long seq;
+    int tries, found;
+
+    if (len >= REALPATH_CACHE_PATH_MAX)
+        return 0;
+
+    entry = realpath_cache_entry(path, len, &hash);
+    for (tries = 0; tries < REALPATH_CACHE_READ_TRIES; tries++) {
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1))
+            return 0;
+        found = entry->hash == hash && entry->len == len && memcmp(entry->path, path, len) == 0;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq)
+            return found;
+    }
+    return 0;
+}
+
+
+/*
+ * Remember the directory at the resolved path of len bytes, which the walk
+ * has just opened as fd, if it stays a directory
+ */
+LOCAL void realpath_cache_store(const char *path, size_t len, int fd)
+{
+    struct realpath_cache_entry *entry;
+    unsigned long long hash;
+    unsigned long seq;
+    struct stat st;
+    int i;
+
+    if (len >= REALPATH_CACHE_PATH_MAX)
+        return;
+
+    if (len > sizeof(ANDROID_NIX_STORE) - 1) {
+        /* A path in the store which is registered */
+        if (strncmp(path, ANDROID_NIX_STORE "/", sizeof(ANDROID_NIX_STORE)) != 0)
+            return;
+        if (fstat(fd, &st) != 0 || st.st_mtime != ANDROID_NIX_STORE_MTIME)
+            return;
+    }
+    else {
+        /* The store or one of its parents */
+        if (strncmp(path, ANDROID_NIX_STORE, len) != 0 || (len < sizeof(ANDROID_NIX_STORE) - 1 && ANDROID_NIX_STORE[len] != '/'))
+            return;
+    }
+
+    entry = realpath_cache_entry(path, len, &hash);
+    for (i = 0; ; i++) {
+        if (i == REALPATH_CACHE_LOCK_TRIES)
+            return;
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(&entry->seq, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    entry->hash = hash;
+    entry->len = len;
+    memcpy(entry->path, path, len);
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,345 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libfakechroot.h"
+#include "exclude_path.h"
+#include "getcwd_cached.h"
+#include "openat.h"
+#include "readlinkat.h"
+#include "rawcall.h"
+#include "realpath_cache.h"
+#include "realpath_walk.h"
+
+
+/*
+   Based on the realpath function taken from Gnulib.
+   Copyright (C) 1996-2010 Free Software Foundation, Inc.
+*/
+
+/*
+ * realpath() as a walk of the directories from the root of the fake chroot.
+ *
+ * The resolved path is built component by component as in the realpath
+ * from Gnulib which was used before, but it is never translated.  The walk
+ * keeps a descriptor of the last directory it has opened with O_PATH and
+ * each component is looked up relative to it, so the kernel walks a single
+ * component instead of the whole prefix and the base directory again.  A
+ * component which is followed by another one is opened as a directory with
+ * O_NOFOLLOW; the last component, and one which is not a directory, is
+ * probed with readlinkat().  ".." is applied to the resolved path, so it
+ * stops at the root of the fake chroot, and a symlink target is narrowed
+ * before it is walked.
+ *
+ * After ".." or an absolute symlink the directory is looked up again from
+ * the base directory descriptor or the translated path, only when the next
+ * component needs it.  The excluded paths are walked on the host.  A
+ * directory which is known to stay one, see realpath_cache.c, is added to
+ * the path relative to the descriptor without a system call.
+ */
+
+#ifndef MAXSYMLINKS
+# ifdef SYMLOOP_MAX
+#  define MAXSYMLINKS SYMLOOP_MAX
+# else
+#  define MAXSYMLINKS 20
+# endif
+#endif
+
+#ifndef O_PATH
+# define O_PATH O_RDONLY
+#endif
+
+/* The resolved prefix on the host */
+struct realpath_at {
+    int fd;         /* the directory, AT_FDCWD or -1 if it must be looked up again */
+    int owned;      /* fd is closed by the walk */
+    int excluded;   /* the prefix is an excluded path */
+    size_t len;
+    char *path;     /* relative to fd, or absolute */
+};
+
+
+static int realpath_openat(int dirfd, const char *path, int flags)
+{
+#ifdef HAVE_RAW_SYSCALLS
+    return rawcall(openat)(dirfd, path, flags, 0);
+#else
+    return nextcall(openat)(dirfd, path, flags);
+#endif
+}
+
+
+static ssize_t realpath_readlinkat(int dirfd, const char *path, char *buf, size_t bufsiz)
+{
+#ifdef HAVE_RAW_SYSCALLS
+    return rawcall(readlinkat)(dirfd, path, buf, bufsiz);
+#else
+    return nextcall(readlinkat)(dirfd, path, buf, bufsiz);
+#endif
+}
+
+
+static void realpath_at_close(struct realpath_at *at)
+{
+    if (at->owned)
+        close(at->fd);
+    at->owned = 0;
+    at->fd = -1;
+}
+
+
+/* Start again from the resolved prefix, which ends at rpath[len] */
+static void realpath_at_reset(struct realpath_at *at, const char *rpath, size_t len)
+{
+    realpath_at_close(at);
+
+    if ((at->excluded = exclude_path_match(rpath))) {
+        at->fd = AT_FDCWD;
+        memcpy(at->path, rpath, len);
+        at->len = len;
+    }
+    else if (fakechroot_base_fd != -1) {
+        at->fd = fakechroot_base_fd;
+        memcpy(at->path, rpath + 1, len - 1);
+        at->len = len - 1;
+    }
+    else {
+        at->fd = AT_FDCWD;
+        memcpy(at->path, ANDROID_BASE, FAKECHROOT_BASE_LEN);
+        memcpy(at->path + FAKECHROOT_BASE_LEN, rpath, len);
+        at->len = FAKECHROOT_BASE_LEN + len;
+    }
+    at->path[at->len] = '\0';
+}
+
+
+static void realpath_at_append(struct realpath_at *at, const char *name, size_t len)
+{
+    if (at->len > 0 && at->path[at->len - 1] != '/')
+        at->path[at->len++] = '/';
+    memcpy(at->path + at->len, name, len);
+    at->len += len;
+    at->path[at->len] = '\0';
+}
+
+
+static void realpath_at_truncate(struct realpath_at *at, size_t len)
+{
+    at->len = len;
+    at->path[len] = '\0';
+}
+
+
+/*
+ * Resolve the name inside the fake chroot into resolved, which has at least
+ * FAKECHROOT_PATH_MAX bytes, or into a new buffer if it is NULL.
+ */
+LOCAL char * realpath_walk(const char * name, char * resolved)
+{
+    fakechroot_buf_decl(rpath);
+    fakechroot_buf_decl(at_path);
+    fakechroot_buf_decl(target);
+    fakechroot_buf_decl(extra);
+    struct realpath_at at = { -1, 0, 0, 0, at_path };
+    const char *start, *end, *cwd;
+    char *dest;
+    size_t cwd_len, parent_len, at_len, len;
+    ssize_t n;
+    int num_links = 0, fd, saved_errno, excluded;
+
+    if (name == NULL) {
+        /* As per Single Unix Specification V2 we must return an error if
+           either parameter is a null pointer.  We extend this to allow
+           the RESOLVED parameter to be NULL in case the we are expected to
+           allocate the room for the return value.  */
+        __set_errno(EINVAL);
+        return NULL;
+    }
+
+    if (name[0] == '\0') {
+        /* As per Single Unix Specification V2 we must return an error if
+           the name argument points to an empty string.  */
+        __set_errno(ENOENT);
+        return NULL;
+    }
+
+    if (name[0] != '/') {
+        if ((cwd = getcwd_cached(&cwd_len)) == NULL) {
+            rpath[0] = '\0';
+            goto error;
+        }
+        if (cwd_len >= FAKECHROOT_PATH_MAX) {
+            __set_errno(ERANGE);
+            rpath[0] = '\0';
+            goto error;
+        }
+        memcpy(rpath, cwd, cwd_len + 1);
+        dest = rpath + cwd_len;
+        at.fd = AT_FDCWD;
+        at.excluded = exclude_path_match(rpath);
+        at_path[0] = '\0';
+    } else {
+        rpath[0] = '/';
+        rpath[1] = '\0';
+        dest = rpath + 1;
+    }
+
+    for (start = end = name; *start; start = end) {
+        /* Skip sequence of multiple path-separators.  */
+        while (*start == '/')
+            ++start;
+
+        /* Find end of path component.  */
+        for (end = start; *end && *end != '/'; ++end)
+            /* Nothing.  */;
+
+        if (end - start == 0)
+            break;
+        else if (end - start == 1 && start[0] == '.') {
+            /* nothing */
+        } else if (end - start == 2 && start[0] == '.' && start[1] == '.') {
+            /* Back up to previous component, ignore if at root already.  */
+            if (dest > rpath + 1) {
+                while (dest[-1] != '/')
+                    --dest;
+                if (dest > rpath + 1)
+                    --dest;
+            }
+            *dest = '\0';
+            realpath_at_close(&at);
+        } else {
+            if (at.fd == -1)
+                realpath_at_reset(&at, rpath, dest - rpath);
+
+            parent_len = dest - rpath;
+            if (dest[-1] != '/')
+                *dest++ = '/';
+
+            if (dest + (end - start) >= rpath + FAKECHROOT_PATH_MAX) {
+                __set_errno(ENAMETOOLONG);
+                dest = rpath + parent_len;
+                *dest = '\0';
+                goto error;
+            }
+
+            memcpy(dest, start, end - start);
+            dest += end - start;
+            *dest = '\0';
+
+            /* The rest of an excluded path is on the host */
+            if ((excluded = !at.excluded && exclude_path_match(rpath))) {
+                realpath_at_close(&at);
+                at.fd = AT_FDCWD;
+                at.excluded = 1;
+                memcpy(at.path, rpath, parent_len);
+                realpath_at_truncate(&at, parent_len);
+            }
+
+            at_len = at.len;
+            realpath_at_append(&at, start, end - start);
+
+            if (*end != '\0') {
+                if (realpath_cache_lookup(rpath, dest - rpath))
+                    continue;
+                if ((fd = realpath_openat(at.fd, at.path, O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC)) != -1) {
+                    realpath_at_close(&at);
+                    at.fd = fd;
+                    at.owned = 1;
+                    realpath_at_truncate(&at, 0);
+                    realpath_cache_store(rpath, dest - rpath, fd);
+                    continue;
+                }
+                /* A symlink or a file */
+                if (errno != ENOTDIR && errno != ELOOP)
+                    goto error;
+            }
+
+            if ((n = realpath_readlinkat(at.fd, at.path, target, FAKECHROOT_PATH_MAX - 1)) == -1) {
+                if (errno != EINVAL)
+                    goto error;
+                if (*end != '\0') {
+                    __set_errno(ENOTDIR);
+                    goto error;
+                }
+                continue;
+            }
+
+            if (++num_links > MAXSYMLINKS) {
+                __set_errno(ELOOP);
+                goto error;
+            }
+
+            target[n] = '\0';
+            n = narrow_chroot_path(target);
+
+            len = strlen(end);
+            if ((size_t)n + len >= FAKECHROOT_PATH_MAX) {
+                __set_errno(ENAMETOOLONG);
+                goto error;
+            }
+
+            /* Careful here, end may be a pointer into extra... */
+            memmove(&extra[n], end, len + 1);
+            name = end = memcpy(extra, target, n);
+
+            if (target[0] == '/') {
+                /* It's an absolute symlink */
+                dest = rpath + 1;
+                realpath_at_close(&at);
+            } else {
+                /* The target is relative to the directory of the link */
+                dest = rpath + parent_len;
+                if (excluded)
+                    realpath_at_close(&at);
+                else
+                    realpath_at_truncate(&at, at_len);
+            }
+            *dest = '\0';
+        }
+    }
+    realpath_at_close(&at);
+
+    len = dest - rpath;
+    if (resolved == NULL && (resolved = malloc(len + 1)) == NULL) {
+        __set_errno(ENOMEM);
+        return NULL;
+    }
+    memcpy(resolved, rpath, len + 1);
+    return resolved;
+
+error:
+    saved_errno = errno;
+    realpath_at_close(&at);
+    /* The prefix which failed is left in the buffer as in glibc */
+    if (resolved != NULL)
+        memcpy(resolved, rpath, strlen(rpath) + 1);
+    __set_errno(saved_errno);
+    return NULL;
+}
@@ -27,12 +27,12 @@
 #include "libfakechroot.h"
 #include "strlcpy.h"
 #include "dedotdot.h"
-#include "getcwd_real.h"
+#include "getcwd_cached.h"
 
 
 LOCAL char * rel2abs(const char * name, char * resolved)
 {
-    char cwd[FAKECHROOT_PATH_MAX - 1];
+    const char *cwd;
 
     debug("rel2abs(\"%s\", &resolved)", name);
 
@@ -46,12 +46,13 @@ LOCAL char * rel2abs(const char * name, char * resolved)
         goto end;
     }
 
-    getcwd_real(cwd, FAKECHROOT_PATH_MAX - 1);
-    narrow_chroot_path(cwd);
-
     if (*name == '/') {
         strlcpy(resolved, name, FAKECHROOT_PATH_MAX);
     }
+    else if ((cwd = getcwd_cached(NULL)) == NULL) {
+        /* Leave it to the kernel if the directory has been removed */
+        strlcpy(resolved, name, FAKECHROOT_PATH_MAX);
+    }
     else {
         snprintf(resolved, FAKECHROOT_PATH_MAX, "%s/%s", cwd, name);
     }
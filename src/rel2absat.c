@@ -34,12 +34,17 @@
 #include "strlcpy.h"
 #include "dedotdot.h"
 #include "open.h"
+#include "fchdir.h"
+#include "fd_path.h"
+#include "getcwd_cached.h"
+#include "getcwd_real.h"
 
 
 LOCAL char * rel2absat(int dirfd, const char * name, char * resolved)
 {
     int cwdfd = 0;
-    char cwd[FAKECHROOT_PATH_MAX - 1];
+    fakechroot_buf_decl(cwd);
+    const char *dir;
 
     debug("rel2absat(%d, \"%s\", &resolved)", dirfd, name);
 
@@ -55,28 +60,37 @@ LOCAL char * rel2absat(int dirfd, const char * name, char * resolved)
 
     if (*name == '/') {
         strlcpy(resolved, name, FAKECHROOT_PATH_MAX);
-    } else if(dirfd == AT_FDCWD) {
-        if (! getcwd(cwd, FAKECHROOT_PATH_MAX - 1)) {
-            goto error;
-        }
-        snprintf(resolved, FAKECHROOT_PATH_MAX, "%s/%s", cwd, name);
     } else {
-        if ((cwdfd = nextcall(open)(".", O_RDONLY|O_DIRECTORY)) == -1) {
-            goto error;
-        }
-
-        if (fchdir(dirfd) == -1) {
-            goto error;
-        }
-        if (! getcwd(cwd, FAKECHROOT_PATH_MAX - 1)) {
-            goto error;
+        if (dirfd == AT_FDCWD) {
+            if ((dir = getcwd_cached(NULL)) == NULL) {
+                goto error;
+            }
+        } else if (fd_path_lookup(dirfd, cwd) != -1) {
+            dir = cwd;
+        } else {
+            /* Without /proc; the wrappers are skipped, so the working
+               directory is not seen as changed */
+            if ((cwdfd = nextcall(open)(".", O_RDONLY|O_DIRECTORY)) == -1) {
+                goto error;
+            }
+
+            if (nextcall(fchdir)(dirfd) == -1) {
+                goto error;
+            }
+            if (! getcwd_real(cwd, FAKECHROOT_PATH_MAX)) {
+                (void)nextcall(fchdir)(cwdfd);
+                goto error;
+            }
+            narrow_chroot_path(cwd);
+            if (nextcall(fchdir)(cwdfd) == -1) {
+                goto error;
+            }
+            (void)close(cwdfd);
+            dir = cwd;
         }
-        if (fchdir(cwdfd) == -1) {
+        if (snprintf(resolved, FAKECHROOT_PATH_MAX, "%s/%s", dir, name) >= FAKECHROOT_PATH_MAX) {
             goto error;
         }
-        (void)close(cwdfd);
-
-        snprintf(resolved, FAKECHROOT_PATH_MAX, "%s/%s", cwd, name);
     }
 
     dedotdot(resolved);
@@ -25,8 +25,7 @@
 
 wrapper(remove, int, (const char * pathname))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("remove(\"%s\")", pathname);
     expand_chroot_path(pathname);
     return nextcall(remove)(pathname);
@@ -27,8 +27,7 @@
 
 wrapper(removexattr, int, (const char * path, const char * name))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("removexattr(\"%s\", \"%s\")", path, name);
     expand_chroot_path(path);
     return nextcall(removexattr)(path, name);
@@ -21,17 +21,22 @@
 #include <config.h>
 
 #include "libfakechroot.h"
+#include "getcwd_cached.h"
 
 
 wrapper(rename, int, (const char * oldpath, const char * newpath))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char tmp[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    fakechroot_buf_decl(tmp);
+    int status;
     debug("rename(\"%s\", \"%s\")", oldpath, newpath);
     expand_chroot_path(oldpath);
     strcpy(tmp, oldpath);
     oldpath = tmp;
     expand_chroot_path(newpath);
-    return nextcall(rename)(oldpath, newpath);
+    /* The working directory could be below the renamed one */
+    if ((status = nextcall(rename)(oldpath, newpath)) == 0) {
+        getcwd_cached_invalidate();
+    }
+    return status;
 }
@@ -24,19 +24,24 @@
 
 #define _ATFILE_SOURCE
 #include "libfakechroot.h"
+#include "getcwd_cached.h"
 
 
 wrapper(renameat, int, (int olddirfd, const char * oldpath, int newdirfd, const char * newpath))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char tmp[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    fakechroot_buf_decl(tmp);
+    int status;
     debug("renameat(%d, \"%s\", %d, \"%s\")", olddirfd, oldpath, newdirfd, newpath);
     expand_chroot_path_at(olddirfd, oldpath);
     strcpy(tmp, oldpath);
     oldpath = tmp;
     expand_chroot_path_at(newdirfd, newpath);
-    return nextcall(renameat)(olddirfd, oldpath, newdirfd, newpath);
+    /* The working directory could be below the renamed one */
+    if ((status = nextcall(renameat)(olddirfd, oldpath, newdirfd, newpath)) == 0) {
+        getcwd_cached_invalidate();
+    }
+    return status;
 }
 
 #else
@@ -24,19 +24,24 @@
 
 #define _ATFILE_SOURCE
 #include "libfakechroot.h"
+#include "getcwd_cached.h"
 
 
 wrapper(renameat2, int, (int olddirfd, const char * oldpath, int newdirfd, const char * newpath, unsigned int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
-    char tmp[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    fakechroot_buf_decl(tmp);
+    int status;
     debug("renameat2(%d, \"%s\", %d, \"%s\", %d)", olddirfd, oldpath, newdirfd, newpath, flags);
     expand_chroot_path_at(olddirfd, oldpath);
     strcpy(tmp, oldpath);
     oldpath = tmp;
     expand_chroot_path_at(newdirfd, newpath);
-    return nextcall(renameat2)(olddirfd, oldpath, newdirfd, newpath, flags);
+    /* The working directory could be below the renamed one */
+    if ((status = nextcall(renameat2)(olddirfd, oldpath, newdirfd, newpath, flags)) == 0) {
+        getcwd_cached_invalidate();
+    }
+    return status;
 }
 
 #else
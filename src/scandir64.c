@@ -29,8 +29,7 @@
 
 wrapper(scandir64, int, (const char * dir, struct dirent64 *** namelist, SCANDIR64_TYPE_ARG3(filter), SCANDIR64_TYPE_ARG4(compar)))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("scandir64(\"%s\", &namelist, &filter, &compar)", dir);
     expand_chroot_path(dir);
     return nextcall(scandir64)(dir, namelist, filter, compar);
@@ -0,0 +1,98 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+
+#include "libfakechroot.h"
+#include "tls.h"
+
+
+/*
+ * Per-thread arena of path buffers for the wrappers.
+ *
+ * The buffers are used as a stack: a wrapper takes the slot on the top and
+ * gives it back when it returns, so the nested calls from the wrappers
+ * themselves and from signal handlers, which always return before the
+ * interrupted wrapper continues, get the next slots.  The depth is set to
+ * the index of the released slot rather than decremented, so a slot which
+ * was never given back (a longjmp out of a signal handler) is reclaimed
+ * when an enclosing wrapper returns.  A vfork child resets the depth itself
+ * before execve(), see fakechroot_scratch_reset().
+ * Without an enclosing wrapper it stays taken, and once the arena is
+ * exhausted the callers take the buffers from their own stack as before.
+ */
+
+LOCAL void * fakechroot_scratch_acquire(void)
+{
+    struct fakechroot_tls *tls = fakechroot_tls();
+    int depth;
+
+    if (tls == NULL || (depth = tls->scratch_depth) >= SCRATCH_DEPTH)
+        return NULL;
+
+    tls->scratch_depth = depth + 1;
+    /* The slot is ours before a signal handler can see the old depth */
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    return &tls->scratch[depth];
+}
+
+
+LOCAL void fakechroot_scratch_release(void * p)
+{
+    struct fakechroot_tls *tls = fakechroot_tls();
+    struct fakechroot_path *slot = p;
+
+    if (tls == NULL || slot < tls->scratch || slot >= tls->scratch + SCRATCH_DEPTH)
+        return;
+
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    tls->scratch_depth = slot - tls->scratch;
+}
+
+
+/* Return the number of the slots taken */
+LOCAL int fakechroot_scratch_depth(void)
+{
+    struct fakechroot_tls *tls = fakechroot_tls();
+
+    return tls != NULL ? tls->scratch_depth : 0;
+}
+
+
+/*
+ * Set the number of the slots taken and return the old one.  A vfork child
+ * gives back the slots before execve(), as the parent shares the arena and
+ * it would never get them back after the successful call.
+ */
+LOCAL int fakechroot_scratch_reset(int depth)
+{
+    struct fakechroot_tls *tls = fakechroot_tls();
+    int old;
+
+    if (tls == NULL)
+        return 0;
+
+    old = tls->scratch_depth;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    tls->scratch_depth = depth;
+    return old;
+}
@@ -20,6 +20,7 @@
 #include <config.h>
 
 #include "libfakechroot.h"
+#include "env_snapshot.h"
 #include "strchrnul.h"
 
 
@@ -135,7 +136,9 @@ static int __add_to_environ(const char *name, const char *value,
 LOCAL int __setenv(const char *name, const char *value, int replace)
 {
         /* NB: setenv("VAR", NULL, 1) inserts "VAR=" string */
-        return __add_to_environ(name, value ? value : "", replace);
+        int rv = __add_to_environ(name, value ? value : "", replace);
+        env_snapshot_update(name);
+        return rv;
 }
 
 LOCAL int __unsetenv(const char *name)
@@ -166,6 +169,7 @@ LOCAL int __unsetenv(const char *name)
                         ++ep;
                 }
         }
+        env_snapshot_update(name);
         return 0;
 }
 
@@ -181,14 +185,19 @@ LOCAL int __clearenv(void)
         last_environ = NULL;
         /* Clearing environ removes the whole environment.  */
         __environ = NULL;
+        env_snapshot_update(NULL);
         return 0;
 }
 
 /* Put STRING, which is of the form "NAME=VALUE", in the environment.  */
 LOCAL int __putenv(char *string)
 {
+        int rv;
+
         if (strchr(string, '=') != NULL) {
-                return __add_to_environ(string, NULL, 1);
+                rv = __add_to_environ(string, NULL, 1);
+                env_snapshot_update(string);
+                return rv;
         }
         return __unsetenv(string);
 }
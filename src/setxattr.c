@@ -27,8 +27,7 @@
 
 wrapper(setxattr, int, (const char * path, const char * name, const void * value, size_t size, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("setxattr(\"%s\", \"%s\", &value, %zd, %d)", path, name, size, flags);
     expand_chroot_path(path);
     return nextcall(setxattr)(path, name, value, size, flags);
@@ -29,15 +29,27 @@
 #include <stdlib.h>
 
 #include "libfakechroot.h"
+#include "fstatat.h"
+#include "rawcall.h"
 
 
 wrapper(stat, int, (const char * file_name, struct stat * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("stat(\"%s\", &buf)", file_name);
     expand_chroot_path(file_name);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        return rawcall(fstatat)(fakechroot_base_fd, relpath, buf, 0);
+    return rawcall(fstatat)(AT_FDCWD, file_name, buf, 0);
+#else
+#ifdef HAVE_FSTATAT
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        return nextcall(fstatat)(fakechroot_base_fd, relpath, buf, 0);
+#endif
     return nextcall(stat)(file_name, buf);
+#endif
 }
 
 #else
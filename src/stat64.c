@@ -30,15 +30,27 @@
 #include <stdlib.h>
 
 #include "libfakechroot.h"
+#include "fstatat64.h"
+#include "rawcall.h"
 
 
 wrapper(stat64, int, (const char * file_name, struct stat64 * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("stat64(\"%s\", &buf)", file_name);
     expand_chroot_path(file_name);
+#ifdef HAVE_RAW_SYSCALLS
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        return rawcall(fstatat64)(fakechroot_base_fd, relpath, buf, 0);
+    return rawcall(fstatat64)(AT_FDCWD, file_name, buf, 0);
+#else
+#ifdef HAVE_FSTATAT64
+    if ((relpath = fakechroot_base_path(file_name)) != NULL)
+        return nextcall(fstatat64)(fakechroot_base_fd, relpath, buf, 0);
+#endif
     return nextcall(stat64)(file_name, buf);
+#endif
 }
 
 #else
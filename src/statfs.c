@@ -33,8 +33,7 @@
 
 wrapper(statfs, int, (const char * path, struct statfs * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("statfs(\"%s\", &buf)", path);
     expand_chroot_path(path);
     return nextcall(statfs)(path, buf);
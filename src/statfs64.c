@@ -29,8 +29,7 @@
 
 wrapper(statfs64, int, (const char * path, struct statfs64 * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("statfs64(\"%s\", &buf)", path);
     expand_chroot_path(path);
     return nextcall(statfs64)(path, buf);
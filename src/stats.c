@@ -0,0 +1,449 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+
+#include "libfakechroot.h"
+#include "stats.h"
+#include "strlcpy.h"
+#include "open.h"
+#include "tls.h"
+
+
+/*
+ * Per-function statistics (FAKECHROOT_STATS=<file>).
+ *
+ * Functions are identified by their __func__ pointer which is interned in
+ * a lock-free open addressing table, so a function gets the same slot in
+ * every thread.  Each thread counts into its own block of entries, which
+ * is mapped on the first use and linked into a list that is never shrunk:
+ * the counters of exited threads are still dumped and no lock is needed.
+ *
+ * fakechroot_path_decl() opens a frame which is closed by the cleanup
+ * attribute when the wrapper returns.  The frames are kept in the thread
+ * state rather than on the stack so a longjmp() out of a wrapper can't
+ * leave a dangling pointer behind.  The expand_chroot_* macros add the
+ * translation time to the frame and nextcall() marks the start of the
+ * underlying call; a function without a frame only counts its calls when
+ * it is not called by another wrapper.
+ *
+ * The statistics are appended as one JSON line per dump to the file, at
+ * exit and when the signal from FAKECHROOT_STATS_SIGNAL is received.
+ */
+
+struct stats_entry {
+    unsigned long long calls;
+    unsigned long long translated;
+    unsigned long long excluded;
+    unsigned long long translate_ns;
+    unsigned long long call_ns;
+    unsigned long long translate_hist[STATS_BUCKETS];
+    unsigned long long call_hist[STATS_BUCKETS];
+};
+
+struct stats_thread {
+    struct stats_thread *next;
+    struct stats_entry entries[STATS_FUNCTIONS];
+};
+
+struct stats_buf {
+    char *buf;
+    size_t len;
+    size_t size;
+};
+
+LOCAL int fakechroot_stats_enabled = 0;
+
+static const char *stats_functions[STATS_FUNCTIONS];
+static struct stats_thread *stats_threads = NULL;
+static char stats_file[FAKECHROOT_PATH_MAX];
+
+
+LOCAL unsigned long long fakechroot_stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+static unsigned int stats_bucket(unsigned long long ns)
+{
+    unsigned int b = 0;
+
+    while (ns > 1 && b < STATS_BUCKETS - 1) {
+        ns >>= 1;
+        b++;
+    }
+    return b;
+}
+
+
+/* Slot of the function, 0 if the table is full */
+static unsigned int stats_function(const char *func)
+{
+    unsigned int mask = STATS_FUNCTIONS - 1;
+    unsigned int i, n;
+
+    i = (unsigned int)(((unsigned long)func >> 3) * 2654435761U) & mask;
+    for (n = 0; n < STATS_FUNCTIONS; n++, i = (i + 1) & mask) {
+        const char *f = __atomic_load_n(&stats_functions[i], __ATOMIC_ACQUIRE);
+
+        if (f == func)
+            return i + 1;
+        if (f == NULL) {
+            if (__atomic_compare_exchange_n(&stats_functions[i], &f, func, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+                return i + 1;
+            if (f == func)
+                return i + 1;
+        }
+    }
+    return 0;
+}
+
+
+static struct stats_thread * stats_thread(struct fakechroot_tls *tls)
+{
+    struct stats_thread *st;
+
+    if ((st = tls->stats) != NULL)
+        return st;
+
+#ifdef HAVE_SYS_MMAN_H
+    st = mmap(NULL, sizeof(struct stats_thread), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (st == MAP_FAILED)
+        return NULL;
+#else
+    if ((st = calloc(1, sizeof(struct stats_thread))) == NULL)
+        return NULL;
+#endif
+
+    st->next = __atomic_load_n(&stats_threads, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&stats_threads, &st->next, st, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    tls->stats = st;
+    return st;
+}
+
+
+static struct stats_entry * stats_entry(struct fakechroot_tls **tlsp, const char *func, unsigned int *idp)
+{
+    struct fakechroot_tls *tls;
+    struct stats_thread *st;
+    unsigned int id;
+
+    if ((tls = fakechroot_tls()) == NULL || (st = stats_thread(tls)) == NULL)
+        return NULL;
+    if ((id = stats_function(func)) == 0)
+        return NULL;
+
+    *tlsp = tls;
+    *idp = id;
+    return &st->entries[id - 1];
+}
+
+
+/* Open a frame for the wrapper and return its depth or 0 */
+LOCAL int fakechroot_stats_enter(const char *func)
+{
+    struct fakechroot_tls *tls;
+    struct stats_frame *f;
+    unsigned int id;
+
+    if (stats_entry(&tls, func, &id) == NULL)
+        return 0;
+
+    /* Frames left by a longjmp() are dropped when the stack is full */
+    if (tls->stats_depth >= STATS_DEPTH)
+        tls->stats_depth = 0;
+
+    f = &tls->stats_frames[tls->stats_depth++];
+    f->id = id;
+    f->start = fakechroot_stats_now();
+    f->translate_ns = 0;
+    f->call_start = 0;
+    f->translated = 0;
+    return tls->stats_depth;
+}
+
+
+/* Add the time spent in the translation of a path */
+LOCAL void fakechroot_stats_translate(int frame, unsigned long long start, int translated)
+{
+    struct fakechroot_tls *tls;
+    struct stats_frame *f;
+
+    if ((tls = fakechroot_tls()) == NULL || frame > tls->stats_depth)
+        return;
+
+    f = &tls->stats_frames[frame - 1];
+    f->translate_ns += fakechroot_stats_now() - start;
+    f->translated |= translated ? STATS_TRANSLATED : STATS_EXCLUDED;
+}
+
+
+/* The underlying function is about to be called */
+LOCAL void fakechroot_stats_nextcall(const char *func)
+{
+    struct fakechroot_tls *tls;
+    struct stats_entry *e;
+    unsigned int id;
+
+    if ((e = stats_entry(&tls, func, &id)) == NULL)
+        return;
+
+    /*
+     * The internal helpers and the wrappers without a frame which are called
+     * by a wrapper are a part of its call
+     */
+    if (tls->stats_depth > 0) {
+        struct stats_frame *f = &tls->stats_frames[tls->stats_depth - 1];
+        if (f->call_start == 0)
+            f->call_start = fakechroot_stats_now();
+        return;
+    }
+
+    e->calls++;
+}
+
+
+/* Close the frame when the wrapper returns */
+LOCAL void fakechroot_stats_leave(int frame)
+{
+    struct fakechroot_tls *tls;
+    struct stats_frame *f;
+    struct stats_entry *e;
+    unsigned long long end;
+
+    if ((tls = fakechroot_tls()) == NULL || tls->stats == NULL || frame > tls->stats_depth)
+        return;
+
+    end = fakechroot_stats_now();
+    f = &tls->stats_frames[frame - 1];
+    e = &tls->stats->entries[f->id - 1];
+    tls->stats_depth = frame - 1;
+
+    e->calls++;
+    if (f->translated & STATS_TRANSLATED)
+        e->translated++;
+    else if (f->translated & STATS_EXCLUDED)
+        e->excluded++;
+    if (f->translated) {
+        e->translate_ns += f->translate_ns;
+        e->translate_hist[stats_bucket(f->translate_ns)]++;
+    }
+    if (f->call_start) {
+        e->call_ns += end - f->call_start;
+        e->call_hist[stats_bucket(end - f->call_start)]++;
+    }
+}
+
+
+/* The JSON is written without stdio so it can be done in a signal handler */
+static void stats_puts(struct stats_buf *b, const char *s)
+{
+    while (*s && b->len < b->size)
+        b->buf[b->len++] = *s++;
+}
+
+
+static void stats_putu(struct stats_buf *b, unsigned long long n)
+{
+    char tmp[24];
+    int i = sizeof(tmp) - 1;
+
+    tmp[i] = '\0';
+    do {
+        tmp[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    stats_puts(b, tmp + i);
+}
+
+
+static void stats_puthist(struct stats_buf *b, const char *name, const unsigned long long *hist)
+{
+    int last, i;
+
+    for (last = STATS_BUCKETS - 1; last > 0 && hist[last] == 0; last--);
+
+    stats_puts(b, ",\"");
+    stats_puts(b, name);
+    stats_puts(b, "\":[");
+    for (i = 0; i <= last; i++) {
+        if (i)
+            stats_puts(b, ",");
+        stats_putu(b, hist[i]);
+    }
+    stats_puts(b, "]");
+}
+
+
+/* Append the statistics of all threads to the file */
+LOCAL void fakechroot_stats_dump(void)
+{
+    struct stats_buf b;
+    struct stats_entry sum;
+    struct stats_thread *st;
+    unsigned int i, j;
+    int fd, first = 1;
+
+    if (*stats_file == '\0')
+        return;
+
+    b.size = STATS_FUNCTIONS * 1024;
+#ifdef HAVE_SYS_MMAN_H
+    if ((b.buf = mmap(NULL, b.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+        return;
+#else
+    if ((b.buf = malloc(b.size)) == NULL)
+        return;
+#endif
+    b.len = 0;
+
+    stats_puts(&b, "{\"pid\":");
+    stats_putu(&b, (unsigned long long)getpid());
+    stats_puts(&b, ",\"functions\":{");
+
+    for (i = 0; i < STATS_FUNCTIONS; i++) {
+        const char *func = __atomic_load_n(&stats_functions[i], __ATOMIC_ACQUIRE);
+
+        if (func == NULL)
+            continue;
+
+        memset(&sum, 0, sizeof(sum));
+        for (st = __atomic_load_n(&stats_threads, __ATOMIC_ACQUIRE); st != NULL; st = st->next) {
+            const struct stats_entry *e = &st->entries[i];
+            sum.calls += e->calls;
+            sum.translated += e->translated;
+            sum.excluded += e->excluded;
+            sum.translate_ns += e->translate_ns;
+            sum.call_ns += e->call_ns;
+            for (j = 0; j < STATS_BUCKETS; j++) {
+                sum.translate_hist[j] += e->translate_hist[j];
+                sum.call_hist[j] += e->call_hist[j];
+            }
+        }
+        if (sum.calls == 0)
+            continue;
+
+        stats_puts(&b, first ? "\"" : ",\"");
+        first = 0;
+        stats_puts(&b, func);
+        stats_puts(&b, "\":{\"calls\":");
+        stats_putu(&b, sum.calls);
+        stats_puts(&b, ",\"translated\":");
+        stats_putu(&b, sum.translated);
+        stats_puts(&b, ",\"excluded\":");
+        stats_putu(&b, sum.excluded);
+        stats_puts(&b, ",\"translate_ns\":");
+        stats_putu(&b, sum.translate_ns);
+        stats_puts(&b, ",\"call_ns\":");
+        stats_putu(&b, sum.call_ns);
+        stats_puthist(&b, "translate_log2_ns", sum.translate_hist);
+        stats_puthist(&b, "call_log2_ns", sum.call_hist);
+        stats_puts(&b, "}");
+    }
+    stats_puts(&b, "}}\n");
+
+    /* One write with O_APPEND keeps the lines of processes apart */
+    if (b.len < b.size && (fd = nextcall(open)(stats_file, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644)) != -1) {
+        if (write(fd, b.buf, b.len) == -1)
+            debug("fakechroot_stats_dump(): write failed");
+        close(fd);
+    }
+
+#ifdef HAVE_SYS_MMAN_H
+    munmap(b.buf, b.size);
+#else
+    free(b.buf);
+#endif
+}
+
+
+/* The counters inherited by a fork() child belong to the parent */
+static void stats_atfork_child(void)
+{
+    struct stats_thread *st;
+
+    for (st = stats_threads; st != NULL; st = st->next)
+        memset(st->entries, 0, sizeof(st->entries));
+}
+
+
+static void stats_signal(int sig)
+{
+    (void)sig;
+    fakechroot_stats_dump();
+}
+
+
+void fakechroot_stats_fini (void) DESTRUCTOR;
+void fakechroot_stats_fini (void)
+{
+    if (fakechroot_stats_enabled)
+        fakechroot_stats_dump();
+}
+
+
+/* Start counting if FAKECHROOT_STATS is set */
+LOCAL void stats_init(void)
+{
+    const char *file = getenv("FAKECHROOT_STATS");
+    const char *sig = getenv("FAKECHROOT_STATS_SIGNAL");
+    struct sigaction sa;
+    int signum;
+
+    if (file == NULL || *file == '\0')
+        return;
+
+    strlcpy(stats_file, file, sizeof(stats_file));
+    fakechroot_stats_enabled = 1;
+
+    pthread_atfork(NULL, NULL, stats_atfork_child);
+
+    /* A handler set already, or the signal ignored by the parent, stays */
+    if (sig != NULL && (signum = atoi(sig)) > 0 && sigaction(signum, NULL, &sa) == 0) {
+        if (!(sa.sa_flags & SA_SIGINFO) && sa.sa_handler == SIG_DFL) {
+            memset(&sa, 0, sizeof(sa));
+            sa.sa_handler = stats_signal;
+            sa.sa_flags = SA_RESTART;
+            sigemptyset(&sa.sa_mask);
+            sigaction(signum, &sa, NULL);
+        }
+        else {
+            debug("stats_init(): signal %d has a handler already", signum);
+        }
+    }
+
+    debug("stats_init(): \"%s\"", file);
+}
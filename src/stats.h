@@ -0,0 +1,48 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __STATS_H
+#define __STATS_H
+
+/* Distinct functions which are counted */
+#define STATS_FUNCTIONS 1024
+
+/* Buckets of the log2 histograms of nanoseconds */
+#define STATS_BUCKETS 32
+
+/* Nested wrapper frames per thread */
+#define STATS_DEPTH 16
+
+#define STATS_TRANSLATED 1
+#define STATS_EXCLUDED 2
+
+struct stats_frame {
+    unsigned int id;
+    int translated;
+    unsigned long long start;
+    unsigned long long translate_ns;
+    unsigned long long call_start;
+};
+
+struct stats_thread;
+
+void stats_init(void);
+void fakechroot_stats_dump(void);
+
+#endif
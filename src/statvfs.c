@@ -28,8 +28,7 @@
 
 wrapper(statvfs, int, (const char * path, struct statvfs * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("statvfs(\"%s\", &buf)", path);
     expand_chroot_path(path);
     return nextcall(statvfs)(path, buf);
@@ -29,8 +29,7 @@
 
 wrapper(statvfs64, int, (const char * path, struct statvfs64 * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("statvfs64(\"%s\", &buf)", path);
     expand_chroot_path(path);
     return nextcall(statvfs64)(path, buf);
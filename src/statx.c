@@ -28,14 +28,29 @@
 #include <unistd.h>
 
 #include "libfakechroot.h"
+#include "rawcall.h"
 
 
 wrapper(statx, int, (int dirfd, const char * pathname, int flags, unsigned int mask, struct statx * statxbuf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
+#if defined(HAVE_RAW_SYSCALLS) && defined(SYS_statx)
+    int retval;
+#endif
     debug("statx(%d, \"%s\", %d, %u, &statxbuf)", dirfd, pathname, flags, mask);
     expand_chroot_path_at(dirfd, pathname);
+#if defined(HAVE_RAW_SYSCALLS) && defined(SYS_statx)
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        retval = rawcall(statx)(fakechroot_base_fd, relpath, flags, mask, statxbuf);
+    else
+        retval = rawcall(statx)(dirfd, pathname, flags, mask, statxbuf);
+    /* The C library emulates statx(2) on kernels older than 4.11 */
+    if (retval == 0 || errno != ENOSYS)
+        return retval;
+#endif
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(statx)(fakechroot_base_fd, relpath, flags, mask, statxbuf);
     return nextcall(statx)(dirfd, pathname, flags, mask, statxbuf);
 }
 
@@ -0,0 +1,267 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <sys/types.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "libfakechroot.h"
+#include "readlink.h"
+#include "symlink_cache.h"
+
+
+/*
+ * Cache of symlink targets.
+ *
+ * lstat() and the *xstat functions read the target of each symlink they
+ * find to report its length in st_size (http://bugs.debian.org/561991).  A
+ * symlink can't be changed in place: another target means a new link, with
+ * a new inode or at least a new ctime.  So the length is cached by device,
+ * inode and ctime, which lstat() has just returned, and readlink() is only
+ * called for a link which wasn't seen before.
+ *
+ * The links in the Nix store never change either: Nix makes a store path
+ * read-only and sets the mtime of its files to 1 when the path is registered,
+ * and the same store path always has the same content.  So the lengths of
+ * these links are also cached by path, which still holds for the same link
+ * with a new inode, ie. a path collected and built again.  The entry is used
+ * only once lstat() has found the link with this mtime: readlink() always
+ * asks the kernel, so it fails for a collected path.  A link with another
+ * mtime belongs to a build which is still writing its output, or it replaced
+ * a collected path, and it drops the cached length of its path.
+ *
+ * The links outside of the base, ie. the excluded ones, are not cached: the
+ * kernel changes the links in /proc in place, ie. /proc/self/fd/N when the
+ * descriptor is reused.
+ *
+ * Both tables are direct mapped and shared by the threads.  The entries are
+ * guarded by a sequence counter, the same as in path_cache.c.
+ */
+
+#define SYMLINK_CACHE_ENTRIES 256
+#define SYMLINK_CACHE_STORE_ENTRIES 256
+#define SYMLINK_CACHE_PATH_MAX 256
+#define SYMLINK_CACHE_LOCK_TRIES 1000
+#define SYMLINK_CACHE_READ_TRIES 4
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+struct symlink_cache_entry {
+    unsigned long seq;
+    struct symlink_cache_key key;
+    size_t len;
+};
+
+struct symlink_cache_store_entry {
+    unsigned long seq;
+    unsigned long long hash;
+    size_t path_len;
+    size_t len;
+    char path[SYMLINK_CACHE_PATH_MAX];
+};
+
+static struct symlink_cache_entry symlink_cache_table[SYMLINK_CACHE_ENTRIES];
+static struct symlink_cache_store_entry symlink_cache_store_table[SYMLINK_CACHE_STORE_ENTRIES];
+
+
+static unsigned long long symlink_cache_hash(unsigned long long h, const void *p, size_t len)
+{
+    const unsigned char *s = p;
+
+    while (len--) {
+        h ^= *s++;
+        h *= FNV64_PRIME;
+    }
+    return h;
+}
+
+
+static unsigned long symlink_cache_lock(unsigned long *seqp)
+{
+    unsigned long seq;
+    int i;
+
+    for (i = 0; i < SYMLINK_CACHE_LOCK_TRIES; i++) {
+        seq = __atomic_load_n(seqp, __ATOMIC_RELAXED);
+        if ((seq & 1) == 0 && __atomic_compare_exchange_n(seqp, &seq, seq + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return seq;
+    }
+    return 1;
+}
+
+
+/*
+ * The translated path of a link in the store, with or without the base
+ * directory, and already canonical
+ */
+static int symlink_cache_in_store(const char *path)
+{
+    if (strncmp(path, ANDROID_BASE, FAKECHROOT_BASE_LEN) == 0 && path[FAKECHROOT_BASE_LEN] == '/')
+        path += FAKECHROOT_BASE_LEN;
+    return strncmp(path, ANDROID_NIX_STORE "/", sizeof(ANDROID_NIX_STORE)) == 0 && strstr(path, "/..") == NULL;
+}
+
+
+static struct symlink_cache_store_entry * symlink_cache_store_entry(const char *path, size_t len, unsigned long long *hash)
+{
+    *hash = symlink_cache_hash(FNV64_OFFSET_BASIS, path, len);
+    return &symlink_cache_store_table[(*hash >> 32) % SYMLINK_CACHE_STORE_ENTRIES];
+}
+
+
+static void symlink_cache_store_path(const char *path, size_t len)
+{
+    struct symlink_cache_store_entry *entry;
+    unsigned long long hash;
+    unsigned long seq;
+    size_t path_len;
+
+    if (!symlink_cache_in_store(path))
+        return;
+    if ((path_len = strnlen(path, SYMLINK_CACHE_PATH_MAX)) == SYMLINK_CACHE_PATH_MAX)
+        return;
+
+    entry = symlink_cache_store_entry(path, path_len, &hash);
+    if ((seq = symlink_cache_lock(&entry->seq)) & 1)
+        return;
+
+    entry->hash = hash;
+    entry->path_len = path_len;
+    entry->len = len;
+    memcpy(entry->path, path, path_len);
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+/* Drop the link which was replaced since it was cached */
+static void symlink_cache_forget_path(const char *path)
+{
+    struct symlink_cache_store_entry *entry;
+    unsigned long long hash;
+    unsigned long seq;
+    size_t path_len;
+
+    if (!symlink_cache_in_store(path))
+        return;
+    if ((path_len = strnlen(path, SYMLINK_CACHE_PATH_MAX)) == SYMLINK_CACHE_PATH_MAX)
+        return;
+
+    entry = symlink_cache_store_entry(path, path_len, &hash);
+    if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == 0 || entry->hash != hash)
+        return;
+    if ((seq = symlink_cache_lock(&entry->seq)) & 1)
+        return;
+
+    if (entry->path_len == path_len && memcmp(entry->path, path, path_len) == 0)
+        entry->path_len = 0;
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+/* Return the cached length of the link in the store or -1 */
+static ssize_t symlink_cache_store_size(const char *path)
+{
+    struct symlink_cache_store_entry *entry;
+    unsigned long long hash;
+    unsigned long seq;
+    size_t path_len, len;
+    int tries;
+
+    if (!symlink_cache_in_store(path))
+        return -1;
+    if ((path_len = strnlen(path, SYMLINK_CACHE_PATH_MAX)) == SYMLINK_CACHE_PATH_MAX)
+        return -1;
+
+    entry = symlink_cache_store_entry(path, path_len, &hash);
+    for (tries = 0; ; tries++) {
+        if (tries == SYMLINK_CACHE_READ_TRIES)
+            return -1;
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1))
+            return -1;
+        if (entry->hash != hash || entry->path_len != path_len || memcmp(entry->path, path, path_len) != 0)
+            return -1;
+        len = entry->len;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq)
+            break;
+    }
+
+    debug("symlink_cache_store_size(\"%s\"): hit", path);
+    return len;
+}
+
+
+/*
+ * Return the length of the narrowed target of the link which lstat() has
+ * just found at the translated path, or -1 if it can't be read.
+ */
+LOCAL ssize_t symlink_cache_size(struct fakechroot_path * fakechroot_path, const char * path, const struct symlink_cache_key * key)
+{
+    struct symlink_cache_entry *entry;
+    fakechroot_buf_decl(tmp);
+    unsigned long long h;
+    unsigned long seq;
+    ssize_t linksize;
+    int tries;
+
+    if (path != fakechroot_path->buf)
+        return readlink_translated(fakechroot_path, path, tmp, FAKECHROOT_PATH_MAX-1);
+
+    h = symlink_cache_hash(FNV64_OFFSET_BASIS, &key->dev, sizeof(key->dev));
+    h = symlink_cache_hash(h, &key->ino, sizeof(key->ino));
+    entry = &symlink_cache_table[(h >> 32) % SYMLINK_CACHE_ENTRIES];
+
+    for (tries = 0; tries < SYMLINK_CACHE_READ_TRIES; tries++) {
+        seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE);
+        if (seq == 0 || (seq & 1))
+            break;
+        if (entry->key.dev != key->dev || entry->key.ino != key->ino ||
+            entry->key.ctime_sec != key->ctime_sec || entry->key.ctime_nsec != key->ctime_nsec)
+            break;
+        linksize = entry->len;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) == seq)
+            return linksize;
+    }
+
+    /* A new link at the path of a link in the store was made in the meantime */
+    if (key->mtime_sec != ANDROID_NIX_STORE_MTIME)
+        symlink_cache_forget_path(path);
+
+    if (key->mtime_sec != ANDROID_NIX_STORE_MTIME || (linksize = symlink_cache_store_size(path)) == -1) {
+        if ((linksize = readlink_translated(fakechroot_path, path, tmp, FAKECHROOT_PATH_MAX-1)) == -1)
+            return -1;
+        if (key->mtime_sec == ANDROID_NIX_STORE_MTIME)
+            symlink_cache_store_path(path, linksize);
+    }
+
+    if (((seq = symlink_cache_lock(&entry->seq)) & 1) == 0) {
+        entry->key = *key;
+        entry->len = linksize;
+        __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    return linksize;
+}
@@ -0,0 +1,47 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __SYMLINK_CACHE_H
+#define __SYMLINK_CACHE_H
+
+#include <sys/types.h>
+#include "libfakechroot.h"
+
+/* Identity of a symlink as returned by lstat(); a new link has a new one */
+struct symlink_cache_key {
+    unsigned long long dev;
+    unsigned long long ino;
+    long long ctime_sec;
+    long ctime_nsec;
+    long long mtime_sec;
+};
+
+/* Works for struct stat and struct stat64 */
+#define symlink_cache_key_init(key, st) \
+    do { \
+        (key)->dev = (st)->st_dev; \
+        (key)->ino = (st)->st_ino; \
+        (key)->ctime_sec = (st)->st_ctim.tv_sec; \
+        (key)->ctime_nsec = (st)->st_ctim.tv_nsec; \
+        (key)->mtime_sec = (st)->st_mtim.tv_sec; \
+    } while (0)
+
+ssize_t symlink_cache_size(struct fakechroot_path *, const char *, const struct symlink_cache_key *);
+
+#endif
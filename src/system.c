@@ -20,48 +20,39 @@
 
 #include <config.h>
 
-#ifdef __GNUC__
+#if defined(__GNUC__) && defined(HAVE_POSIX_SPAWN)
 
 #define _BSD_SOURCE
 #define _POSIX_SOURCE
 #define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <errno.h>
 #include <unistd.h>
 #include <signal.h>
+#include <spawn.h>
 #include "libfakechroot.h"
 
 
-/* #include <sys/types.h> */
-/* #include <stdlib.h> */
-/* #include <unistd.h> */
-/* #include <sys/wait.h> */
+/*
+ * The shell is started with posix_spawn() of this library.  SIGINT and
+ * SIGQUIT are ignored and SIGCHLD is blocked in the caller while it waits,
+ * the child gets the original signal mask and the default actions back.
+ */
 wrapper(system, int, (const char * command))
 {
     pid_t pid;
-    int pstat;
-    sigset_t mask, omask;
+    int pstat, status;
+    char *argv[] = { "sh", "-c", (char *)command, NULL };
+    sigset_t mask, omask, defaults;
     struct sigaction new_action_ign, old_action_int, old_action_quit;
+    posix_spawnattr_t attr;
 
     debug("system(\"%s\")", command);
     if (command == 0)
         return 1;
 
-    sigemptyset(&mask);
-    sigaddset(&mask, SIGCHLD);
-    sigprocmask(SIG_BLOCK, &mask, &omask);
-
-    if ((pid = vfork()) < 0) {
-        sigprocmask(SIG_SETMASK, &omask, NULL);
-        return -1;
-    }
-    if (pid == 0) {
-        sigprocmask(SIG_SETMASK, &omask, NULL);
-
-        execl("/bin/sh", "sh", "-c", command, (char *) 0);
-        _exit(127);
-    }
-
     new_action_ign.sa_handler = SIG_IGN;
     sigemptyset(&new_action_ign.sa_mask);
     new_action_ign.sa_flags = 0;
@@ -69,7 +60,35 @@ wrapper(system, int, (const char * command))
     sigaction(SIGINT, &new_action_ign, &old_action_int);
     sigaction(SIGQUIT, &new_action_ign, &old_action_quit);
 
-    pid = waitpid(pid, (int *)&pstat, 0);
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, &omask);
+
+    /* Ignored signals stay ignored in the shell */
+    sigemptyset(&defaults);
+    if (old_action_int.sa_handler != SIG_IGN)
+        sigaddset(&defaults, SIGINT);
+    if (old_action_quit.sa_handler != SIG_IGN)
+        sigaddset(&defaults, SIGQUIT);
+
+    if ((status = posix_spawnattr_init(&attr)) == 0) {
+        posix_spawnattr_setsigmask(&attr, &omask);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+        status = posix_spawn(&pid, "/bin/sh", NULL, &attr, argv, environ);
+        posix_spawnattr_destroy(&attr);
+    }
+
+    if (status == 0) {
+        do {
+            pid = waitpid(pid, &pstat, 0);
+        } while (pid == -1 && errno == EINTR);
+    }
+    else {
+        /* The same as the shell which couldn't be executed */
+        pid = 0;
+        pstat = 127 << 8;
+    }
 
     sigprocmask(SIG_SETMASK, &omask, NULL);
 
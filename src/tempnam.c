@@ -25,8 +25,7 @@
 
 wrapper(tempnam, char *, (const char * dir, const char * pfx))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("tempnam(\"%s\", \"%s\")", dir, pfx);
     expand_chroot_path(dir);
     return nextcall(tempnam)(dir, pfx);
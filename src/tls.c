@@ -0,0 +1,106 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+
+#include "libfakechroot.h"
+#include "tls.h"
+#include "trace.h"
+#include "translation_cache.h"
+
+
+/*
+ * The state is allocated on the first use in the thread so threads which
+ * never call a wrapper don't pay for it, and it is kept out of the static
+ * TLS block which glibc carves from the thread stack.  It is mapped rather
+ * than malloc'ed because wrappers run in constructors and vfork children.
+ */
+
+static pthread_key_t fakechroot_tls_key;
+static pthread_once_t fakechroot_tls_once = PTHREAD_ONCE_INIT;
+static int fakechroot_tls_key_created = 0;
+
+#ifdef THREAD_LOCAL
+static THREAD_LOCAL struct fakechroot_tls *fakechroot_tls_self;
+#endif
+
+
+static void fakechroot_tls_destroy(void * tls)
+{
+#ifdef THREAD_LOCAL
+    /* Other destructors of the exiting thread can still call wrappers */
+    fakechroot_tls_self = NULL;
+#endif
+    translation_cache_flush(tls);
+    trace_release(tls);
+#ifdef HAVE_SYS_MMAN_H
+    munmap(tls, sizeof(struct fakechroot_tls));
+#else
+    free(tls);
+#endif
+}
+
+
+static void fakechroot_tls_key_create(void)
+{
+    fakechroot_tls_key_created = pthread_key_create(&fakechroot_tls_key, fakechroot_tls_destroy) == 0;
+}
+
+
+/* Return the state of the current thread or NULL if it can't be allocated */
+LOCAL struct fakechroot_tls * fakechroot_tls(void)
+{
+    struct fakechroot_tls *tls;
+
+#ifdef THREAD_LOCAL
+    if ((tls = fakechroot_tls_self) != NULL)
+        return tls;
+#endif
+
+    pthread_once(&fakechroot_tls_once, fakechroot_tls_key_create);
+
+#ifndef THREAD_LOCAL
+    if (fakechroot_tls_key_created && (tls = pthread_getspecific(fakechroot_tls_key)) != NULL)
+        return tls;
+#endif
+
+#ifdef HAVE_SYS_MMAN_H
+    tls = mmap(NULL, sizeof(struct fakechroot_tls), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (tls == MAP_FAILED)
+        return NULL;
+#else
+    if ((tls = calloc(1, sizeof(struct fakechroot_tls))) == NULL)
+        return NULL;
+#endif
+
+    if (fakechroot_tls_key_created)
+        pthread_setspecific(fakechroot_tls_key, tls);
+#ifdef THREAD_LOCAL
+    fakechroot_tls_self = tls;
+#endif
+
+    return tls;
+}
@@ -0,0 +1,78 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __TLS_H
+#define __TLS_H
+
+#include <stddef.h>
+#include "libfakechroot.h"
+#include "stats.h"
+
+struct trace_ring;
+
+/* Paths longer than this are not kept in the translation cache */
+#define TRANSLATION_CACHE_PATH_MAX 256
+#define TRANSLATION_CACHE_SIZE 64
+
+/* Path buffers in the arena of fakechroot_scratch_acquire() */
+#define SCRATCH_DEPTH 16
+
+struct translation_cache_entry {
+    unsigned int seq;
+    unsigned long generation;
+    unsigned int hash;
+    unsigned short path_len;
+    unsigned short abspath_len;
+    int verdict;
+    char path[TRANSLATION_CACHE_PATH_MAX];
+    char abspath[TRANSLATION_CACHE_PATH_MAX];
+};
+
+/* Per-thread state of the library */
+struct fakechroot_tls {
+    /* getcwd_cached() */
+    unsigned long cwd_generation;
+    const char *cwd_path;
+    size_t cwd_path_len;
+    size_t cwd_host_len;
+    char cwd_host[FAKECHROOT_PATH_MAX];
+
+    /* translation_cache_lookup() */
+    unsigned long tcache_hits;
+    unsigned long tcache_misses;
+    struct translation_cache_entry tcache[TRANSLATION_CACHE_SIZE];
+
+    /* fakechroot_trace() */
+    struct trace_ring *trace_ring;
+    unsigned long trace_epoch;
+    unsigned int trace_tid;
+
+    /* fakechroot_stats_enter() */
+    struct stats_thread *stats;
+    int stats_depth;
+    struct stats_frame stats_frames[STATS_DEPTH];
+
+    /* fakechroot_scratch_acquire() */
+    int scratch_depth;
+    struct fakechroot_path scratch[SCRATCH_DEPTH];
+};
+
+struct fakechroot_tls * fakechroot_tls(void);
+
+#endif
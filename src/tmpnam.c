@@ -29,8 +29,7 @@
 
 wrapper(tmpnam, char *, (char * s))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     char *ptr, *ptr2;
 
     debug("tmpnam(&s)");
@@ -0,0 +1,291 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+
+#include "libfakechroot.h"
+#include "trace.h"
+#include "open.h"
+#include "tls.h"
+
+
+/*
+ * Binary trace of the path translation.
+ *
+ * With FAKECHROOT_TRACE=<file> every translated path is recorded as a fixed
+ * size event in a file named <file>.<pid> (or <file>.<pid>.<n> after exec)
+ * which is mapped shared, so the events survive a crash and nothing is
+ * formatted or written while the program runs.  The file is a header, a
+ * table of wrapper names and TRACE_RINGS rings of TRACE_RING_EVENTS events.
+ * A thread takes a free ring on its first event and gives it back when it
+ * exits, so a ring is written by one thread at a time and the events need
+ * no locking.  scripts/fakechroot-trace decodes the file.
+ *
+ * The file name is a host path: it is not translated.
+ */
+
+#define TRACE_FNV_OFFSET_BASIS 2166136261U
+#define TRACE_FNV_PRIME 16777619U
+
+LOCAL int fakechroot_trace_enabled = 0;
+
+#ifdef HAVE_SYS_MMAN_H
+
+static struct trace_file_header *trace_map = NULL;
+static size_t trace_map_size = 0;
+
+/* Bumped in the child after fork(): the rings of the parent are gone */
+static unsigned long trace_epoch = 1;
+
+
+static uint32_t trace_hash(const char *s)
+{
+    uint32_t h = TRACE_FNV_OFFSET_BASIS;
+
+    if (s == NULL)
+        return 0;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= TRACE_FNV_PRIME;
+    }
+    return h;
+}
+
+
+static uint32_t trace_gettid(void)
+{
+#ifdef SYS_gettid
+    return (uint32_t)syscall(SYS_gettid);
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+
+static struct trace_ring * trace_ring(struct trace_file_header *map, unsigned int i)
+{
+    return (struct trace_ring *)((char *)map + TRACE_RINGS_OFFSET + (size_t)i * TRACE_RING_SIZE);
+}
+
+
+/* Create the trace file and map it */
+static void trace_open(void)
+{
+    const char *name = getenv("FAKECHROOT_TRACE");
+    char path[FAKECHROOT_PATH_MAX];
+    struct trace_file_header *map;
+    size_t size = TRACE_FILE_SIZE;
+    struct timespec ts;
+    int fd = -1, n;
+
+    fakechroot_trace_enabled = 0;
+    if (name == NULL || *name == '\0')
+        return;
+
+    /* exec() keeps the pid, so don't overwrite the trace of the old image */
+    for (n = 0; n < 100 && fd == -1; n++) {
+        if (n == 0)
+            snprintf(path, sizeof(path), "%s.%d", name, (int)getpid());
+        else
+            snprintf(path, sizeof(path), "%s.%d.%d", name, (int)getpid(), n);
+        fd = nextcall(open)(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    }
+    if (fd == -1) {
+        debug("trace_open(): cannot create \"%s\"", path);
+        return;
+    }
+
+    if (ftruncate(fd, size) == -1 ||
+        (map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        debug("trace_open(): cannot map \"%s\"", path);
+        close(fd);
+        return;
+    }
+    close(fd);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    map->version = TRACE_VERSION;
+    map->event_size = sizeof(struct trace_event);
+    map->rings = TRACE_RINGS;
+    map->ring_events = TRACE_RING_EVENTS;
+    map->names_max = TRACE_NAMES;
+    map->pid = getpid();
+    map->start = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    memcpy(map->magic, TRACE_MAGIC, sizeof(map->magic));
+
+    trace_map = map;
+    trace_map_size = size;
+    fakechroot_trace_enabled = 1;
+
+    debug("trace_open(): \"%s\"", path);
+}
+
+
+static void trace_atfork_child(void)
+{
+    struct fakechroot_tls *tls;
+
+    /* The rings of other threads don't exist in the child */
+    if (trace_map != NULL) {
+        munmap(trace_map, trace_map_size);
+        trace_map = NULL;
+    }
+    trace_epoch++;
+    if ((tls = fakechroot_tls()) != NULL)
+        tls->trace_ring = NULL;
+    trace_open();
+}
+
+
+/* Start the trace if FAKECHROOT_TRACE is set */
+LOCAL void trace_init(void)
+{
+    const char *name = getenv("FAKECHROOT_TRACE");
+
+    if (name == NULL || *name == '\0')
+        return;
+
+    pthread_atfork(NULL, NULL, trace_atfork_child);
+    trace_open();
+}
+
+
+/* Take a free ring for the thread */
+static struct trace_ring * trace_ring_claim(struct fakechroot_tls *tls)
+{
+    struct trace_file_header *map = trace_map;
+    uint32_t tid = trace_gettid();
+    unsigned int i;
+
+    for (i = 0; i < TRACE_RINGS; i++) {
+        struct trace_ring *ring = trace_ring(map, i);
+        uint32_t owner = 0;
+
+        if (__atomic_compare_exchange_n(&ring->owner, &owner, tid, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            tls->trace_ring = ring;
+            tls->trace_epoch = trace_epoch;
+            tls->trace_tid = tid;
+            return ring;
+        }
+    }
+
+    __atomic_add_fetch(&map->dropped, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+
+/* Give the ring back when the thread exits */
+LOCAL void trace_release(struct fakechroot_tls *tls)
+{
+    struct trace_ring *ring = tls->trace_ring;
+
+    tls->trace_ring = NULL;
+    if (ring != NULL && tls->trace_epoch == trace_epoch)
+        __atomic_store_n(&ring->owner, 0, __ATOMIC_RELEASE);
+}
+
+
+/* Record the name of the wrapper once per call site */
+static void trace_name(struct trace_file_header *map, uint32_t id, const char *func)
+{
+    uint32_t i = __atomic_fetch_add(&map->names_used, 1, __ATOMIC_RELAXED);
+    struct trace_name *name;
+
+    if (i >= TRACE_NAMES)
+        return;
+
+    name = (struct trace_name *)((char *)map + TRACE_NAMES_OFFSET) + i;
+    strncpy(name->name, func, sizeof(name->name) - 1);
+    __atomic_store_n(&name->id, id, __ATOMIC_RELEASE);
+}
+
+
+/* Record a translation made by the wrapper func */
+LOCAL void fakechroot_trace(unsigned long *site, const char *func, const char *in, const char *out, struct fakechroot_path *fp)
+{
+    struct trace_file_header *map = trace_map;
+    struct fakechroot_tls *tls;
+    struct trace_ring *ring;
+    struct trace_event *ev;
+    struct timespec ts;
+    uint64_t head;
+    uint32_t id;
+
+    if (map == NULL || (tls = fakechroot_tls()) == NULL)
+        return;
+
+    if ((ring = tls->trace_ring) == NULL || tls->trace_epoch != trace_epoch) {
+        tls->trace_ring = NULL;
+        if ((ring = trace_ring_claim(tls)) == NULL)
+            return;
+    }
+
+    id = trace_hash(func);
+    if (*site != trace_epoch) {
+        *site = trace_epoch;
+        trace_name(map, id, func);
+    }
+
+    /* The slot is taken first so a signal handler gets the next one */
+    head = ring->head;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ev = &ring->events[head % TRACE_RING_EVENTS];
+    ev->time = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    ev->tid = tls->trace_tid;
+    ev->id = id;
+    ev->in_hash = trace_hash(in);
+    ev->out_hash = trace_hash(out);
+    ev->flags = (out != NULL && out == fp->buf) ? TRACE_TRANSLATED : 0;
+    if (out == in)
+        ev->flags |= TRACE_UNCHANGED;
+}
+
+#else
+
+LOCAL void trace_init(void)
+{
+}
+
+LOCAL void trace_release(struct fakechroot_tls *tls)
+{
+}
+
+LOCAL void fakechroot_trace(unsigned long *site, const char *func, const char *in, const char *out, struct fakechroot_path *fp)
+{
+}
+
+#endif
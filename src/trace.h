@@ -0,0 +1,85 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <stdint.h>
+#include "libfakechroot.h"
+
+/* Layout of the FAKECHROOT_TRACE file, all fields in host byte order */
+
+#define TRACE_MAGIC "FCTRACE\n"
+#define TRACE_VERSION 1
+
+#define TRACE_NAMES 1024
+#define TRACE_RINGS 64
+#define TRACE_RING_EVENTS 8192
+
+/* Event flags */
+#define TRACE_TRANSLATED 1
+#define TRACE_UNCHANGED 2
+
+struct trace_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t event_size;
+    uint32_t rings;
+    uint32_t ring_events;
+    uint32_t names_max;
+    uint32_t names_used;
+    uint32_t dropped;
+    uint32_t pid;
+    uint64_t start;
+};
+
+struct trace_name {
+    uint32_t id;
+    char name[60];
+};
+
+struct trace_event {
+    uint64_t time;
+    uint32_t tid;
+    uint32_t id;
+    uint32_t in_hash;
+    uint32_t out_hash;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct trace_ring {
+    uint32_t owner;
+    uint32_t reserved;
+    uint64_t head;
+    char pad[48];
+    struct trace_event events[TRACE_RING_EVENTS];
+};
+
+#define TRACE_NAMES_OFFSET 4096
+#define TRACE_RINGS_OFFSET (TRACE_NAMES_OFFSET + TRACE_NAMES * sizeof(struct trace_name))
+#define TRACE_RING_SIZE sizeof(struct trace_ring)
+#define TRACE_FILE_SIZE (TRACE_RINGS_OFFSET + TRACE_RINGS * TRACE_RING_SIZE)
+
+struct fakechroot_tls;
+
+void trace_init(void);
+void trace_release(struct fakechroot_tls *);
+
+#endif
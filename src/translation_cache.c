@@ -0,0 +1,218 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <stddef.h>
+#include <string.h>
+
+#include "libfakechroot.h"
+#include "translation_cache.h"
+#include "getcwd_cached.h"
+#include "tls.h"
+#include "vfork_child.h"
+
+
+/*
+ * Per-thread cache of translated paths.
+ *
+ * The translation is lexical: the result depends only on the path, the
+ * exclude list and, for a relative path, the working directory.  So an
+ * absolute path is cached for good and a relative path is cached together
+ * with the generation of getcwd_cached(), which the wrappers that change
+ * or move the working directory bump.  A vfork() child shares the cache and
+ * the generation with its parent but not its working directory, so it
+ * doesn't store the relative paths.
+ *
+ * The cache is direct mapped and an entry keeps either the input path
+ * (excluded), the absolute path (excluded after rel2abs) or the absolute
+ * path to be prefixed with the base.  Canonical absolute paths are not
+ * looked up at all: they are translated with a single scan which is
+ * cheaper than hashing and comparing them.
+ */
+
+#define FNV_OFFSET_BASIS 2166136261U
+#define FNV_PRIME 16777619U
+
+#define TRANSLATION_CACHE_FLUSH 256
+
+static unsigned long translation_cache_hits = 0;
+static unsigned long translation_cache_misses = 0;
+
+
+/* Move the counters of the thread to the global ones */
+LOCAL void translation_cache_flush(struct fakechroot_tls * tls)
+{
+    if (tls->tcache_hits != 0)
+        __atomic_add_fetch(&translation_cache_hits, tls->tcache_hits, __ATOMIC_RELAXED);
+    if (tls->tcache_misses != 0)
+        __atomic_add_fetch(&translation_cache_misses, tls->tcache_misses, __ATOMIC_RELAXED);
+    tls->tcache_hits = 0;
+    tls->tcache_misses = 0;
+}
+
+
+static void translation_cache_count(struct fakechroot_tls * tls, unsigned long * counter)
+{
+    (*counter)++;
+    if (((tls->tcache_hits + tls->tcache_misses) % TRANSLATION_CACHE_FLUSH) == 0)
+        translation_cache_flush(tls);
+}
+
+
+/* Look the path up; on a hit store the result in *result and return 1 */
+LOCAL int translation_cache_lookup(struct translation_cache_key * key, struct fakechroot_path * fp, const char * path, char ** result)
+{
+    struct fakechroot_tls *tls;
+    struct translation_cache_entry *e;
+    unsigned int h = FNV_OFFSET_BASIS;
+    unsigned int seq;
+    size_t len;
+
+    key->entry = NULL;
+
+    if ((len = strnlen(path, TRANSLATION_CACHE_PATH_MAX)) == TRANSLATION_CACHE_PATH_MAX)
+        return 0;
+    if ((tls = fakechroot_tls()) == NULL)
+        return 0;
+
+    for (key->len = len; len--; path++) {
+        h ^= (unsigned char)*path;
+        h *= FNV_PRIME;
+    }
+    path -= key->len;
+
+    key->generation = 0;
+    if (*path != '/') {
+        key->generation = getcwd_cached_generation();
+        h ^= (unsigned int)key->generation;
+        h *= FNV_PRIME;
+    }
+    key->hash = h;
+    key->entry = e = &tls->tcache[h % TRANSLATION_CACHE_SIZE];
+
+    /* A signal handler can overwrite the entry while it is being copied */
+    seq = __atomic_load_n(&e->seq, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+
+    if ((seq & 1) || e->hash != h || e->generation != key->generation || e->path_len != key->len ||
+        e->verdict == TRANSLATION_CACHE_EMPTY || memcmp(e->path, path, key->len) != 0) {
+        translation_cache_count(tls, &tls->tcache_misses);
+        return 0;
+    }
+
+    switch (e->verdict) {
+    case TRANSLATION_CACHE_ORIGINAL:
+        *result = (char *)path;
+        break;
+    case TRANSLATION_CACHE_EXCLUDED:
+        memcpy(fp->buf + FAKECHROOT_BASE_LEN, e->abspath, e->abspath_len + 1);
+        fp->len = e->abspath_len;
+        *result = fp->buf + FAKECHROOT_BASE_LEN;
+        break;
+    default:
+        memcpy(fp->buf, ANDROID_BASE, FAKECHROOT_BASE_LEN);
+        memcpy(fp->buf + FAKECHROOT_BASE_LEN, e->abspath, e->abspath_len + 1);
+        fp->len = FAKECHROOT_BASE_LEN + e->abspath_len;
+        *result = fp->buf;
+        break;
+    }
+
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != seq) {
+        translation_cache_count(tls, &tls->tcache_misses);
+        return 0;
+    }
+
+    translation_cache_count(tls, &tls->tcache_hits);
+    return 1;
+}
+
+
+/* Remember the result of the translation after a miss and return it */
+LOCAL char * translation_cache_store(struct translation_cache_key * key, struct fakechroot_path * fp, const char * path, char * result)
+{
+    struct translation_cache_entry *e = key->entry;
+    const char *abspath = fp->buf + FAKECHROOT_BASE_LEN;
+    size_t len = 0;
+    unsigned int seq;
+    int verdict;
+
+    if (e == NULL)
+        return result;
+    if (key->generation != 0 && vfork_child())
+        return result;
+
+    if (result == path) {
+        verdict = TRANSLATION_CACHE_ORIGINAL;
+    }
+    else if (result == fp->buf) {
+        verdict = TRANSLATION_CACHE_TRANSLATED;
+        len = fp->len - FAKECHROOT_BASE_LEN;
+    }
+    else {
+        verdict = TRANSLATION_CACHE_EXCLUDED;
+        len = fp->len;
+    }
+    if (len >= TRANSLATION_CACHE_PATH_MAX)
+        return result;
+
+    seq = __atomic_load_n(&e->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+
+    e->hash = key->hash;
+    e->generation = key->generation;
+    e->path_len = key->len;
+    memcpy(e->path, path, key->len);
+    if (verdict != TRANSLATION_CACHE_ORIGINAL) {
+        memcpy(e->abspath, abspath, len + 1);
+        e->abspath_len = len;
+    }
+    e->verdict = verdict;
+
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&e->seq, seq + 2, __ATOMIC_RELAXED);
+
+    return result;
+}
+
+
+/* Counters of all threads except the unflushed part of other threads */
+void fakechroot_translation_cache_stats(unsigned long * hits, unsigned long * misses)
+{
+    struct fakechroot_tls *tls;
+
+    if ((tls = fakechroot_tls()) != NULL)
+        translation_cache_flush(tls);
+    if (hits != NULL)
+        *hits = __atomic_load_n(&translation_cache_hits, __ATOMIC_RELAXED);
+    if (misses != NULL)
+        *misses = __atomic_load_n(&translation_cache_misses, __ATOMIC_RELAXED);
+}
+
+
+void fakechroot_translation_cache_fini (void) DESTRUCTOR;
+void fakechroot_translation_cache_fini (void)
+{
+    unsigned long hits, misses;
+
+    fakechroot_translation_cache_stats(&hits, &misses);
+    debug("translation cache: %lu hits, %lu misses", hits, misses);
+}
@@ -0,0 +1,47 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#ifndef __TRANSLATION_CACHE_H
+#define __TRANSLATION_CACHE_H
+
+#include <stddef.h>
+#include "libfakechroot.h"
+
+#define TRANSLATION_CACHE_EMPTY 0
+#define TRANSLATION_CACHE_ORIGINAL 1
+#define TRANSLATION_CACHE_EXCLUDED 2
+#define TRANSLATION_CACHE_TRANSLATED 3
+
+struct fakechroot_tls;
+struct translation_cache_entry;
+
+/* Filled by translation_cache_lookup() for translation_cache_store() */
+struct translation_cache_key {
+    struct translation_cache_entry *entry;
+    unsigned long generation;
+    unsigned int hash;
+    size_t len;
+};
+
+int translation_cache_lookup(struct translation_cache_key *, struct fakechroot_path *, const char *, char **);
+char * translation_cache_store(struct translation_cache_key *, struct fakechroot_path *, const char *, char *);
+void translation_cache_flush(struct fakechroot_tls *);
+void fakechroot_translation_cache_stats(unsigned long *, unsigned long *);
+
+#endif
@@ -26,8 +26,7 @@
 
 wrapper(truncate, int, (const char * path, off_t length))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("truncate(\"%s\", %d)", path, length);
     expand_chroot_path(path);
     return nextcall(truncate)(path, length);
@@ -21,13 +21,18 @@
 #include <config.h>
 
 #include "libfakechroot.h"
+#include "unlinkat.h"
 
 
 wrapper(unlink, int, (const char * pathname))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("unlink(\"%s\")", pathname);
     expand_chroot_path(pathname);
+#ifdef HAVE_UNLINKAT
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(unlinkat)(fakechroot_base_fd, relpath, 0);
+#endif
     return nextcall(unlink)(pathname);
 }
@@ -28,10 +28,12 @@
 
 wrapper(unlinkat, int, (int dirfd, const char * pathname, int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
+    const char *relpath;
     debug("unlinkat(%d, \"%s\", %d)", dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
+    if ((relpath = fakechroot_base_path(pathname)) != NULL)
+        return nextcall(unlinkat)(fakechroot_base_fd, relpath, flags);
     return nextcall(unlinkat)(dirfd, pathname, flags);
 }
 
@@ -26,8 +26,7 @@
 
 wrapper(utime, int, (const char * filename, const struct utimbuf * buf))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("utime(\"%s\", &buf)", filename);
     expand_chroot_path(filename);
     return nextcall(utime)(filename, buf);
@@ -30,8 +30,7 @@
 
 wrapper(utimensat, int, (int dirfd, const char * pathname, const struct timespec times [2], int flags))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("utimeat(%d, \"%s\", &buf, %d)", dirfd, pathname, flags);
     expand_chroot_path_at(dirfd, pathname);
     return nextcall(utimensat)(dirfd, pathname, times, flags);
@@ -26,8 +26,7 @@
 
 wrapper(utimes, int, (const char * filename, UTIMES_TYPE_ARG2(tv)))
 {
-    char fakechroot_abspath[FAKECHROOT_PATH_MAX];
-    char fakechroot_buf[FAKECHROOT_PATH_MAX];
+    fakechroot_path_decl();
     debug("utimes(\"%s\", &tv)", filename);
     expand_chroot_path(filename);
     return nextcall(utimes)(filename, tv);
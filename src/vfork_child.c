@@ -0,0 +1,58 @@
+/*
+    libfakechroot -- fake chroot environment
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+
+#include <config.h>
+
+#include <sys/types.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "libfakechroot.h"
+#include "vfork_child.h"
+
+
+/*
+ * A vfork() child runs on the memory of its parent, including the
+ * per-thread state of the library, until it calls execve() or _exit().
+ * The child is told by its pid: the pid of the process is kept in a global
+ * which a fork() child updates and a vfork() child, which runs no fork
+ * handlers, doesn't.
+ */
+
+static pid_t vfork_child_pid = 0;
+
+
+static void vfork_child_atfork(void)
+{
+    vfork_child_pid = getpid();
+}
+
+
+LOCAL void vfork_child_init(void)
+{
+    vfork_child_pid = getpid();
+    pthread_atfork(NULL, NULL, vfork_child_atfork);
+}
+
+
+/* Check if this is a vfork() child; it makes a system call */
+LOCAL int vfork_child(void)
+{
+    return vfork_child_pid != 0 && getpid() != vfork_child_pid;
+}
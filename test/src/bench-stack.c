@@ -0,0 +1,134 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <spawn.h>
+
+/*
+ * Measure the stack high-water mark of a few wrappers.  Each call is made
+ * in a new thread whose stack is filled with a pattern beforehand, and the
+ * untouched part of the stack is found by the pattern afterwards.  The
+ * figures include the C library below the wrapper, so compare them with a
+ * run without libfakechroot.
+ */
+
+#define STACK_SIZE (256 * 1024)
+#define STACK_PATTERN 0xa5
+
+extern char **environ;
+
+static void call_stat (void) {
+    struct stat st;
+    stat("/etc/hostname", &st);
+}
+
+static void call_lstat (void) {
+    struct stat st;
+    lstat("/etc/../etc/hostname", &st);
+}
+
+static void call_open (void) {
+    int fd;
+    if ((fd = open("/etc/hostname", O_RDONLY)) != -1) {
+        close(fd);
+    }
+}
+
+static void call_readlink (void) {
+    char buf[256];
+    readlink("/etc/hostname", buf, sizeof(buf));
+}
+
+static void call_realpath (void) {
+    char *path;
+    if ((path = realpath("/etc/../etc/hostname", NULL)) != NULL) {
+        free(path);
+    }
+}
+
+static void call_rename (void) {
+    rename("/nonexistent/a", "/nonexistent/b");
+}
+
+static void call_execve (void) {
+    char *argv[] = { "nonexistent", NULL };
+    execve("/nonexistent", argv, environ);
+}
+
+static void call_posix_spawn (void) {
+    char *argv[] = { "nonexistent", NULL };
+    pid_t pid;
+    posix_spawn(&pid, "/nonexistent", NULL, NULL, argv, environ);
+}
+
+static struct {
+    const char *name;
+    void (*fn)(void);
+} calls[] = {
+    { "stat", call_stat },
+    { "lstat", call_lstat },
+    { "open", call_open },
+    { "readlink", call_readlink },
+    { "realpath", call_realpath },
+    { "rename", call_rename },
+    { "execve", call_execve },
+    { "posix_spawn", call_posix_spawn },
+    { NULL, NULL }
+};
+
+static void * run (void * arg) {
+    ((void (*)(void))arg)();
+    return NULL;
+}
+
+static size_t high_water (void (*fn)(void)) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    unsigned char *stack;
+    size_t i;
+
+    stack = mmap(NULL, STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    memset(stack, STACK_PATTERN, STACK_SIZE);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, STACK_SIZE);
+    if (pthread_create(&thread, &attr, run, (void *)fn) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* The stack grows down from the end of the mapping */
+    for (i = 0; i < STACK_SIZE && stack[i] == STACK_PATTERN; i++);
+    munmap(stack, STACK_SIZE);
+    return STACK_SIZE - i;
+}
+
+int main (void) {
+    int i;
+
+    /* The first calls fill the caches of the process */
+    for (i = 0; calls[i].name != NULL; i++) {
+        high_water(calls[i].fn);
+    }
+
+    for (i = 0; calls[i].name != NULL; i++) {
+        printf("%-12s %8zu bytes\n", calls[i].name, high_water(calls[i].fn));
+    }
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+
+/*
+ * Measure the startup of a process under libfakechroot.  The program
+ * starts itself again and again: the parent shows the cost of fork, exec
+ * and the library constructor together, the child shows the cost of the
+ * first call of a few wrapped functions compared with the next call, which
+ * is where the lazy symbol lookup used to be paid.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+# define TICKS_UNIT "cycles"
+static unsigned long long ticks (void) {
+    return __builtin_ia32_rdtsc();
+}
+#else
+# define TICKS_UNIT "ns"
+static unsigned long long ticks (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+static unsigned long long calls (void) {
+    struct stat st;
+    char buf[256];
+    unsigned long long start;
+    DIR *dir;
+    int fd;
+
+    start = ticks();
+    stat("/etc/hostname", &st);
+    lstat("/etc/hostname", &st);
+    access("/etc/hostname", R_OK);
+    readlink("/etc/hostname", buf, sizeof(buf));
+    if ((fd = open("/etc/hostname", O_RDONLY)) != -1) {
+        close(fd);
+    }
+    if ((dir = opendir("/etc")) != NULL) {
+        closedir(dir);
+    }
+    return ticks() - start;
+}
+
+static int child (void) {
+    unsigned long long t[2];
+
+    t[0] = calls();
+    t[1] = calls();
+    return write(STDOUT_FILENO, t, sizeof(t)) == sizeof(t) ? 0 : 1;
+}
+
+int main (int argc, char *argv[]) {
+    long iterations = 1000;
+    unsigned long long spawn = 0, first = 0, next = 0, start, t[2];
+    char *child_argv[] = { argv[0], "-child", NULL };
+    char exe[64];
+    int fds[2], status, exe_fd;
+    pid_t pid;
+    long i;
+
+    if (argc > 1 && strcmp(argv[1], "-child") == 0) {
+        return child();
+    }
+    if (argc > 1) {
+        iterations = atol(argv[1]);
+    }
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        exit(2);
+    }
+
+    /*
+     * The path is neither translated nor resolved by the ELF loader which
+     * might be started instead of the program.
+     */
+    if ((exe_fd = open("/proc/self/exe", O_RDONLY)) == -1) {
+        perror("/proc/self/exe");
+        exit(1);
+    }
+    snprintf(exe, sizeof(exe), "/proc/self/fd/%d", exe_fd);
+
+    for (i = 0; i < iterations; i++) {
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            exit(1);
+        }
+        start = ticks();
+        if ((pid = fork()) == -1) {
+            perror("fork");
+            exit(1);
+        }
+        if (pid == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+            execv(exe, child_argv);
+            _exit(127);
+        }
+        close(fds[1]);
+        if (read(fds[0], t, sizeof(t)) != sizeof(t) || waitpid(pid, &status, 0) != pid || status != 0) {
+            fprintf(stderr, "%s: child failed\n", argv[0]);
+            exit(1);
+        }
+        spawn += ticks() - start;
+        close(fds[0]);
+        first += t[0];
+        next += t[1];
+    }
+
+    printf("%-8s %12.1f %s/process\n", "spawn", (double)spawn / iterations, TICKS_UNIT);
+    printf("%-8s %12.1f %s/process\n", "first", (double)first / iterations, TICKS_UNIT);
+    printf("%-8s %12.1f %s/process\n", "next", (double)next / iterations, TICKS_UNIT);
+
+    return 0;
+}
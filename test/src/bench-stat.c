@@ -0,0 +1,104 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <time.h>
+
+/*
+ * Measure the cost of stat(2) for each path given on the command line.
+ * Started under libfakechroot it shows the cost of the path translation:
+ * compare a canonical path with the same path spelled with "." or ".."
+ * components, and both with the raw syscall which is not translated.
+ * Run it with FAKECHROOT_BASE_FD=1 to compare the string prefix with the
+ * base directory descriptor.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+# define TICKS_UNIT "cycles"
+static unsigned long long ticks (void) {
+    return __builtin_ia32_rdtsc();
+}
+#else
+# define TICKS_UNIT "ns"
+static unsigned long long ticks (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+static const char *default_paths[] = {
+    "/etc/hostname",
+    "/etc/./hostname",
+    "/usr/../etc/hostname",
+    "etc/hostname",
+    NULL
+};
+
+enum bench_op { BENCH_STAT, BENCH_OPEN, BENCH_RAW };
+
+static void bench (const char *name, const char *path, long iterations, enum bench_op op) {
+    struct stat st;
+    unsigned long long start, end;
+    long i;
+    int fd;
+
+    start = ticks();
+    for (i = 0; i < iterations; i++) {
+        switch (op) {
+        case BENCH_STAT:
+            stat(path, &st);
+            break;
+        case BENCH_OPEN:
+            if ((fd = open(path, O_RDONLY)) != -1) {
+                close(fd);
+            }
+            break;
+        case BENCH_RAW:
+#ifdef SYS_newfstatat
+            syscall(SYS_newfstatat, AT_FDCWD, path, &st, 0);
+#endif
+            break;
+        }
+    }
+    end = ticks();
+
+    printf("%-8s %-40s %10.1f %s/call\n", name, path, (double)(end - start) / iterations, TICKS_UNIT);
+}
+
+int main (int argc, char *argv[]) {
+    long iterations = 1000000;
+    const char **paths = default_paths;
+    int i;
+
+    if (argc > 1) {
+        iterations = atol(argv[1]);
+    }
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations [path...]]\n", argv[0]);
+        exit(2);
+    }
+    if (argc > 2) {
+        paths = (const char **)argv + 2;
+    }
+
+    if (chdir("/") != 0) {
+        perror("chdir");
+        exit(1);
+    }
+
+    for (i = 0; paths[i] != NULL; i++) {
+        bench("stat", paths[i], iterations, BENCH_STAT);
+    }
+    bench("open", paths[0], iterations, BENCH_OPEN);
+#ifdef SYS_newfstatat
+    bench("syscall", paths[0], iterations, BENCH_RAW);
+#endif
+
+    return 0;
+}
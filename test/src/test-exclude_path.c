@@ -0,0 +1,27 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define X10 "xxxxxxxxxx"
+#define X100 X10 X10 X10 X10 X10 X10 X10 X10 X10 X10
+
+#undef ANDROID_EXCLUDE_PATH
+#define ANDROID_EXCLUDE_PATH "/proc:/sys:/dev::/storage/emulated:/apex/:/sys:/" X100 X100 X100 ":/system"
+
+#include "../../src/exclude_path.c"
+
+int fakechroot_debug (const char *fmt, ...) {
+    return 0;
+}
+
+int main (int argc, char *argv[]) {
+    if (argc < 2 || argc > 2) {
+        fprintf(stderr, "Usage: %s path\n", argv[0]);
+        exit(2);
+    }
+
+    exclude_path_init();
+    printf("%d\n", exclude_path_match(argv[1]));
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+extern char **environ;
+
+int main (int argc, char* argv[]) {
+    char **newargv;
+    long count, i;
+    int n;
+
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s execve|execvp|posix_spawn|posix_spawnp count cmd [arg...]\n", argv[0]);
+        exit(2);
+    }
+
+    count = atol(argv[2]);
+    if ((newargv = malloc((argc - 3 + count + 1) * sizeof(char *))) == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+
+    for (n = 0; n < argc - 3; n++) {
+        newargv[n] = argv[n + 3];
+    }
+    for (i = 0; i < count; i++) {
+        newargv[n + i] = i == count - 1 ? "last" : "x";
+    }
+    newargv[n + count] = NULL;
+
+    if (strcmp(argv[1], "execve") == 0) {
+        execve(newargv[0], newargv, environ);
+        perror("execve");
+    } else if (strcmp(argv[1], "execvp") == 0) {
+        execvp(newargv[0], newargv);
+        perror("execvp");
+    } else {
+        pid_t pid;
+        int status;
+
+        if (strcmp(argv[1], "posix_spawn") == 0) {
+            status = posix_spawn(&pid, newargv[0], NULL, NULL, newargv, environ);
+        } else {
+            status = posix_spawnp(&pid, newargv[0], NULL, NULL, newargv, environ);
+        }
+
+        if (status != 0) {
+            fprintf(stderr, "%s() failed: %s\n", argv[1], strerror(status));
+            return status;
+        }
+        if (waitpid(pid, &status, 0) == -1) {
+            perror("waitpid");
+            exit(1);
+        }
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    }
+
+    exit(1);
+
+    /* Execution should never reach here */
+    return 1;
+}
@@ -0,0 +1,36 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#define _ATFILE_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/*
+ * Open the relative path below the directory descriptor and print "ok".
+ */
+
+int main (int argc, char *argv[]) {
+    int dirfd, fd;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s /path/to/dir relative/path\n", argv[0]);
+        exit(2);
+    }
+
+    if ((dirfd = open(argv[1], O_RDONLY | O_DIRECTORY)) == -1) {
+        perror("open");
+        exit(1);
+    }
+    if ((fd = openat(dirfd, argv[2], O_RDONLY)) == -1) {
+        perror("openat");
+        exit(1);
+    }
+    printf("ok\n");
+
+    close(fd);
+    close(dirfd);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Run the command found in PATH=dir1:dir2 with posix_spawnp() and with
+ * execvp() in a vfork child while it is added to and removed from these
+ * directories.  Each run prints the directory of the command or "-".
+ */
+
+extern char **environ;
+
+static char *cmd;
+
+static void command (const char *dir, const char *output) {
+    char path[4096];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, cmd);
+    if (output == NULL) {
+        if (unlink(path) == -1) {
+            perror("unlink");
+            exit(1);
+        }
+        return;
+    }
+    if ((f = fopen(path, "w")) == NULL) {
+        perror("fopen");
+        exit(1);
+    }
+    fprintf(f, "#!/bin/sh\nprintf '%s '\n", output);
+    fclose(f);
+    chmod(path, 0755);
+}
+
+static void run (void) {
+    char *args[2] = { cmd, NULL };
+    pid_t pid;
+    int status;
+
+    if ((status = posix_spawnp(&pid, cmd, NULL, NULL, args, environ)) != 0)
+        write(1, "- ", 2);
+    else
+        waitpid(pid, &status, 0);
+
+    if ((pid = vfork()) == -1) {
+        perror("vfork");
+        exit(1);
+    }
+    if (pid == 0) {
+        execvp(cmd, args);
+        write(1, "- ", 2);
+        _exit(127);
+    }
+    waitpid(pid, &status, 0);
+}
+
+int main (int argc, char *argv[]) {
+    char path[8192];
+
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s cmd dir1 dir2\n", argv[0]);
+        exit(2);
+    }
+
+    cmd = argv[1];
+    snprintf(path, sizeof(path), "%s:%s", argv[2], argv[3]);
+    setenv("PATH", path, 1);
+
+    mkdir(argv[2], 0755);
+    mkdir(argv[3], 0755);
+    command(argv[3], "2");
+    /* Changes in the last second are not cached */
+    sleep(2);
+
+    run();
+    command(argv[2], "1");
+    run();
+    command(argv[2], NULL);
+    run();
+    command(argv[3], NULL);
+    run();
+    write(1, "\n", 1);
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/*
+ * Start the command from many threads at once with posix_spawn(), vfork()
+ * with execv(), system() and popen(), which run the exec wrappers in the
+ * children sharing the memory of the parent and keep the popen() streams in
+ * a list shared by the threads.  Prints the number of the children which
+ * exited with 0.
+ */
+
+extern char **environ;
+
+static const char *cmd;
+static long iterations;
+
+static int run (long i) {
+    char *argv[] = { (char *)cmd, NULL };
+    pid_t pid;
+    int status;
+    FILE *fp;
+
+    switch (i % 4) {
+    case 0:
+        if (posix_spawn(&pid, cmd, NULL, NULL, argv, environ) != 0)
+            return 0;
+        break;
+    case 1:
+        if ((pid = vfork()) == -1)
+            return 0;
+        if (pid == 0) {
+            execv(cmd, argv);
+            _exit(127);
+        }
+        break;
+    case 2:
+        status = system(cmd);
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    default:
+        if ((fp = popen(cmd, "r")) == NULL)
+            return 0;
+        while (fgetc(fp) != EOF);
+        status = pclose(fp);
+        return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    if (waitpid(pid, &status, 0) != pid)
+        return 0;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void * thread (void * arg) {
+    long i, ok = 0;
+
+    (void)arg;
+    for (i = 0; i < iterations; i++) {
+        ok += run(i);
+    }
+    return (void *)ok;
+}
+
+int main (int argc, char* argv[]) {
+    pthread_t *threads;
+    long nthreads, i, ok = 0;
+    void *result;
+
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s threads iterations cmd\n", argv[0]);
+        exit(2);
+    }
+
+    nthreads = atol(argv[1]);
+    iterations = atol(argv[2]);
+    cmd = argv[3];
+
+    if ((threads = malloc(nthreads * sizeof(pthread_t))) == NULL) {
+        perror("malloc");
+        exit(1);
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        if (pthread_create(&threads[i], NULL, thread, NULL) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], &result);
+        ok += (long)result;
+    }
+
+    printf("%ld\n", ok);
+    return 0;
+}
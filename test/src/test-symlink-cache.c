@@ -0,0 +1,114 @@
+#define _ATFILE_SOURCE
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+
+/*
+ * Replace a symlink behind the back of the library with the system calls
+ * and print the target read before and after lstat() of the new link, then
+ * remove it and check that readlink() fails.  A link with the mtime of a
+ * registered Nix store path is remembered, but readlink() must see the
+ * changes at once, as a garbage collection of the store makes them.
+ * Then check that lstat() of /proc/self/fd/N gives the length of the link
+ * for the descriptor opened with the directory and reused for "/".
+ */
+
+static void print_link (const char *path, const char *sep) {
+    char buf[256];
+    ssize_t sz;
+
+    if ((sz = readlink(path, buf, sizeof(buf) - 1)) < 0) {
+        perror("readlink");
+        exit(1);
+    }
+    buf[sz] = '\0';
+    printf("%s%s", buf, sep);
+}
+
+static void print_size (const char *path, const char *sep) {
+    struct stat st;
+
+    if (lstat(path, &st)) {
+        perror("lstat");
+        exit(1);
+    }
+    printf("%d%s", (int)st.st_size, sep);
+}
+
+static void print_proc (const char *path, const char *sep) {
+    char proc[64], buf[1024];
+    struct stat st;
+    ssize_t sz;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) == -1) {
+        perror("open");
+        exit(1);
+    }
+    snprintf(proc, sizeof(proc), "/proc/self/fd/%d", fd);
+    if (lstat(proc, &st) || (sz = readlink(proc, buf, sizeof(buf))) < 0) {
+        perror("lstat");
+        exit(1);
+    }
+    printf("%s%s", st.st_size == sz ? "same" : "differs", sep);
+    close(fd);
+}
+
+int main (int argc, char *argv[]) {
+    struct timespec times[2] = { { 1, 0 }, { 1, 0 } };
+    char path[1024], buf[256];
+    int dirfd;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s /path/to/dir name\n", argv[0]);
+        exit(2);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", argv[1], argv[2]);
+
+    if ((dirfd = open(argv[1], O_RDONLY | O_DIRECTORY)) == -1) {
+        perror("open");
+        exit(1);
+    }
+
+    unlink(path);
+    if (symlink("target-a", path) || utimensat(AT_FDCWD, path, times, AT_SYMLINK_NOFOLLOW)) {
+        perror("symlink");
+        exit(1);
+    }
+
+    print_link(path, " ");
+    print_size(path, " ");
+
+    if (syscall(SYS_unlinkat, dirfd, argv[2], 0) || syscall(SYS_symlinkat, "target-bb", dirfd, argv[2])) {
+        perror("syscall");
+        exit(1);
+    }
+
+    print_link(path, " ");
+    print_size(path, " ");
+    print_link(path, " ");
+
+    if (syscall(SYS_unlinkat, dirfd, argv[2], 0)) {
+        perror("syscall");
+        exit(1);
+    }
+    if (readlink(path, buf, sizeof(buf)) != -1 || errno != ENOENT) {
+        printf("exists\n");
+        exit(1);
+    }
+    printf("gone ");
+
+    print_proc(argv[1], " ");
+    print_proc("/", "\n");
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+
+/*
+ * Change the directory in a vfork() child and resolve a relative path
+ * there, then print the directory the parent resolves "." against.
+ */
+
+int main (int argc, char *argv[]) {
+    char buf[PATH_MAX];
+    pid_t pid;
+    int status;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s /path/to/dir\n", argv[0]);
+        exit(2);
+    }
+
+    /* The parent knows its directory before vfork() */
+    if (realpath(".", buf) == NULL) {
+        perror("realpath");
+        exit(1);
+    }
+
+    if ((pid = vfork()) == -1) {
+        perror("vfork");
+        exit(1);
+    }
+    if (pid == 0) {
+        if (chdir(argv[1]) != 0 || realpath(".", buf) == NULL)
+            _exit(1);
+        _exit(0);
+    }
+    if (waitpid(pid, &status, 0) != pid || status != 0) {
+        fprintf(stderr, "%s: child failed\n", argv[0]);
+        exit(1);
+    }
+
+    if (realpath(".", buf) == NULL) {
+        perror("realpath");
+        exit(1);
+    }
+    printf("%s\n", buf);
+
+    return 0;
+}
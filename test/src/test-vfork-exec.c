@@ -0,0 +1,96 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Run the program with vfork() and execve() once and then many times in a
+ * thread and print "ok" if the stack used is about the same.  The wrappers
+ * take their path buffers from the stack when the arena is exhausted, which
+ * happens if the children leave the slots of their parent taken.
+ */
+
+#define STACK_SIZE (256 * 1024)
+#define STACK_PATTERN 0xa5
+#define STACK_SLACK 1024
+
+extern char **environ;
+
+static char *program;
+
+static void * run (void *arg) {
+    char *args[2] = { program, NULL };
+    pid_t pid;
+    int i, status;
+
+    for (i = 0; i < *(int *)arg; i++) {
+        if ((pid = vfork()) == -1) {
+            perror("vfork");
+            exit(1);
+        }
+        if (pid == 0) {
+            execve(program, args, environ);
+            _exit(127);
+        }
+        if (waitpid(pid, &status, 0) != pid || status != 0) {
+            fprintf(stderr, "child failed\n");
+            exit(1);
+        }
+    }
+    return NULL;
+}
+
+static size_t high_water (int count) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    unsigned char *stack;
+    size_t i;
+
+    stack = mmap(NULL, STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED) {
+        perror("mmap");
+        exit(1);
+    }
+    memset(stack, STACK_PATTERN, STACK_SIZE);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, STACK_SIZE);
+    if (pthread_create(&thread, &attr, run, &count) != 0) {
+        perror("pthread_create");
+        exit(1);
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    /* The stack grows down from the end of the mapping */
+    for (i = 0; i < STACK_SIZE && stack[i] == STACK_PATTERN; i++);
+    munmap(stack, STACK_SIZE);
+    return STACK_SIZE - i;
+}
+
+int main (int argc, char *argv[]) {
+    size_t once, many;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s count /path/to/program\n", argv[0]);
+        exit(2);
+    }
+
+    program = argv[2];
+
+    once = high_water(1);
+    many = high_water(atoi(argv[1]));
+    if (many > once + STACK_SLACK) {
+        printf("%zu > %zu\n", many, once);
+        return 1;
+    }
+    printf("ok\n");
+
+    return 0;
+}
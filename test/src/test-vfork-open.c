@@ -0,0 +1,66 @@
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/*
+ * Open the relative path in the first directory, then change to the second
+ * directory and open the same path in a vfork() child, and print the first
+ * line of the file the parent opens again.
+ */
+
+static void print_file (const char *path) {
+    char buf[256];
+    ssize_t sz;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) == -1) {
+        perror("open");
+        exit(1);
+    }
+    if ((sz = read(fd, buf, sizeof(buf) - 1)) < 0) {
+        perror("read");
+        exit(1);
+    }
+    buf[sz] = '\0';
+    printf("%s", buf);
+    close(fd);
+}
+
+int main (int argc, char *argv[]) {
+    pid_t pid;
+    int fd, status;
+
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s /path/to/dir1 /path/to/dir2 file\n", argv[0]);
+        exit(2);
+    }
+
+    if (chdir(argv[1]) != 0) {
+        perror("chdir");
+        exit(1);
+    }
+    print_file(argv[3]);
+
+    if ((pid = vfork()) == -1) {
+        perror("vfork");
+        exit(1);
+    }
+    if (pid == 0) {
+        if (chdir(argv[2]) != 0 || (fd = open(argv[3], O_RDONLY)) == -1)
+            _exit(1);
+        _exit(0);
+    }
+    if (waitpid(pid, &status, 0) != pid || status != 0) {
+        fprintf(stderr, "%s: child failed\n", argv[0]);
+        exit(1);
+    }
+
+    print_file(argv[3]);
+
+    return 0;
+}
@@ -3,7 +3,7 @@
 srcdir=${srcdir:-.}
 . $srcdir/common.inc.sh
 
-prepare 8
+prepare 11
 
 cwd=`pwd`
 cmddir=`cd $srcdir; pwd`/t
@@ -36,6 +36,21 @@ t=`$srcdir/fakechroot.sh $testtree /bin/pwd 2>&1`
 test "$t" = "/bin/pwd" || not
 ok "fakechroot pwd [6] is" $t
 
+t=`$srcdir/fakechroot.sh $testtree /bin/test-posix_spawn /bin/pwd x 2>&1`
+test "$t" = "/bin/pwd" || not
+ok "fakechroot posix_spawn pwd is" $t
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-posix_spawnp pwd x 2>&1`
+test "$t" = "/bin/pwd" || not
+ok "fakechroot posix_spawnp pwd is" $t
+
+many=`i=0; while [ $i -lt 100 ]; do printf '/no/file%d=foo:' $i; i=$((i+1)); done`
+export FAKECHROOT_CMD_SUBST="$many/bin/pwd=$cmddir/cmd-subst-pwd.sh"
+
+t=`$srcdir/fakechroot.sh $testtree /bin/pwd 2>&1`
+test "$t" = "/bin/pwd" || not
+ok "fakechroot pwd after 100 elements is" $t
+
 export FAKECHROOT_CMD_SUBST="/no/file=foo:/other/file=bar"
 
 t=`$srcdir/bin/fakechroot /bin/pwd 2>&1`
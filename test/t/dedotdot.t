@@ -3,7 +3,7 @@
 srcdir=${srcdir:-.}
 . $srcdir/common.inc.sh
 
-plan 47
+plan 58
 
 dedotdot="$srcdir/src/test-dedotdot"
 
@@ -55,6 +55,17 @@ set -- \
     /abcdef/ghijkl/../mnopqr /abcdef/mnopqr \
     abcdef/ghijkl/../mnopqr abcdef/mnopqr \
     /abcdef/ghijkl/mnopqr/.. /abcdef/ghijkl \
+    ./ . \
+    ./. . \
+    ../. .. \
+    a/./b/ a/b/ \
+    a/b/../ a/ \
+    a/../ . \
+    ../a/.. ../a/.. \
+    a/../../b/../c ../b/../c \
+    /../a/../b/./c/ /b/c/ \
+    /nix/store/0123456789abcdefghijklmnopqrstuv-foo-1.0/lib/../lib/./../bin/foo /nix/store/0123456789abcdefghijklmnopqrstuv-foo-1.0/bin/foo \
+    /nix/store/0123456789abcdefghijklmnopqrstuv-foo-1.0/lib/../../../../../etc /etc \
 
 while [ $# -gt 1 ]; do
     t=`$dedotdot "$1" 2>&1`
@@ -0,0 +1,43 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+plan 25
+
+exclude_path="$srcdir/src/test-exclude_path"
+long=`printf '%0300d' 0 | tr 0 x`
+
+set -- \
+    /proc 1 \
+    /proc/ 1 \
+    /proc/self/fd 1 \
+    /procfs 0 \
+    /pro 0 \
+    / 0 \
+    '' 0 \
+    proc 0 \
+    /sys 1 \
+    /sys/kernel 1 \
+    /dev/null 1 \
+    /device 0 \
+    /storage 0 \
+    /storage/emulated 1 \
+    /storage/emulated/0/Download 1 \
+    /storage/emulatedx 0 \
+    /apex 0 \
+    /apex/ 1 \
+    /apex/com.android.runtime 0 \
+    /apex//x 1 \
+    /system/bin/sh 1 \
+    /systemd 0 \
+    /$long 1 \
+    /$long/a 1 \
+    /${long}x 0 \
+
+while [ $# -gt 1 ]; do
+    t=`$exclude_path "$1" 2>&1`
+    test "$t" = "$2" || not
+    ok "test-exclude_path $1 returns" $t
+    shift 2
+done
@@ -0,0 +1,34 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 8
+
+count=100000
+
+for chroot in chroot fakechroot; do
+
+    if [ $chroot = "chroot" ] && ! is_root; then
+        skip $(( $tap_plan / 2 )) "not root"
+    else
+
+        printf "#!/bin/sh\necho \$# \${$count}\n" > $testtree/bin/test-count
+        chmod a+x $testtree/bin/test-count
+
+        for func in execve posix_spawn; do
+            t=`$srcdir/$chroot.sh $testtree /bin/test-exec-many-args $func $count /bin/sh -c 'echo $# ${'$count'}' sh 2>&1`
+            test "$t" = "$count last" || not
+            ok "$chroot $func with $count arguments returns" $t
+        done
+
+        for func in execvp posix_spawnp; do
+            t=`$srcdir/$chroot.sh $testtree /bin/test-exec-many-args $func $count test-count 2>&1`
+            test "$t" = "$count last" || not
+            ok "$chroot $func with $count arguments for script returns" $t
+        done
+
+    fi
+done
+
+cleanup
@@ -11,10 +11,17 @@ libjemalloc=`
 `
 test $libjemalloc = "no" && skip_all 'jemalloc library is missing (sudo apt-get install libjemalloc-dev)'
 
-prepare 1
+prepare 2
 
 t=`$srcdir/fakechroot.sh $testtree sh -c 'LD_PRELOAD="$LD_PRELOAD '$libjemalloc'" cat /CHROOT' 2>&1`
 test "$t" = "testtree-jemalloc" || not
 ok "fakechroot LD_PRELOAD=$libjemalloc cat:" $t
 
+printf "#!/bin/sh\nexit 0\n" > $testtree/bin/test-true
+chmod a+x $testtree/bin/test-true
+
+t=`$srcdir/fakechroot.sh $testtree sh -c 'LD_PRELOAD="$LD_PRELOAD '$libjemalloc'" test-spawn-threads 8 30 /bin/test-true' 2>&1`
+test "$t" = "240" || not
+ok "fakechroot LD_PRELOAD=$libjemalloc test-spawn-threads returns" $t
+
 cleanup
@@ -0,0 +1,27 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 3
+
+mkdir -p $testtree/openat-dir/a
+echo "something" > $testtree/openat-dir/a/b
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-openat /openat-dir a/b 2>&1`
+test "$t" = "ok" || not
+ok "fakechroot openat below the directory is" $t
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-openat / proc/self/status 2>&1`
+test "$t" = "ok" || not
+ok "fakechroot openat of the excluded path is" $t
+
+mkdir -p $testtree/openat-real/sub/dir
+echo "something" > $testtree/openat-real/sub/x
+ln -s openat-real/sub/dir $testtree/openat-link
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-openat /openat-link ../x 2>&1`
+test "$t" = "ok" || not
+ok "fakechroot openat of .. below the symlink to the directory is" $t
+
+cleanup
@@ -0,0 +1,23 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+for chroot in chroot fakechroot; do
+
+    if [ $chroot = "chroot" ] && ! is_root; then
+        skip $(( $tap_plan / 2 )) "not root"
+    else
+
+        rm -rf $testtree/tmp/path-cache-1 $testtree/tmp/path-cache-2
+        t=`$srcdir/$chroot.sh $testtree /bin/test-path-cache test-path-cache-cmd /tmp/path-cache-1 /tmp/path-cache-2 2>&1`
+        test "$t" = "2 2 1 1 2 2 - - " || not
+        ok "$chroot command search in PATH follows the changes of directories:" $t
+
+    fi
+
+done
+
+cleanup
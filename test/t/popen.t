@@ -3,7 +3,7 @@
 srcdir=${srcdir:-.}
 . $srcdir/common.inc.sh
 
-prepare 2
+prepare 4
 
 for chroot in chroot fakechroot; do
 
@@ -18,6 +18,13 @@ for chroot in chroot fakechroot; do
         test "$t" = "something" || not
         ok "$chroot popen returns" $t
 
+        printf "#!/bin/sh\nexit 0\n" > $testtree/bin/test-true
+        chmod a+x $testtree/bin/test-true
+
+        t=`$srcdir/$chroot.sh $testtree /bin/test-spawn-threads 8 20 /bin/test-true 2>&1`
+        test "$t" = "160" || not
+        ok "$chroot popen and pclose from threads returns" $t
+
     fi
 
 done
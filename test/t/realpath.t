@@ -3,7 +3,7 @@
 srcdir=${srcdir:-.}
 . $srcdir/common.inc.sh
 
-prepare 28
+prepare 32
 
 buf=`for i in $($SEQ 1 1024); do printf "A"; done`
 
@@ -58,6 +58,15 @@ for chroot in chroot fakechroot; do
         test "$t" = "/$chroot-file" || not
         ok "$chroot symlink's realpath with buf is really" $t
 
+        t=`$srcdir/$chroot.sh $testtree /bin/test-realpath /../../$chroot-dir/../$chroot-file 2>&1`
+        test "$t" = "/$chroot-file" || not
+        ok "$chroot realpath stops at the root:" $t
+
+        ln -s $chroot-dir $testtree/$chroot-rel-symlink-dir
+        t=`$srcdir/$chroot.sh $testtree /bin/test-realpath $chroot-rel-symlink-dir/../$chroot-symlink-dir/ 2>&1`
+        test "$t" = "/$chroot-dir" || not
+        ok "$chroot realpath through relative and absolute symlinks is really" $t
+
     fi
 
 done
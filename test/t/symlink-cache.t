@@ -0,0 +1,19 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+# Nix sets the mtime of the registered store paths to 1
+mkdir -p $testtree/nix/store/00000000000000000000000000000000-test $testtree/tmp
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-symlink-cache /nix/store/00000000000000000000000000000000-test link 2>&1`
+test "$t" = "target-a 8 target-bb 9 target-bb gone same same" || not
+ok "fakechroot symlink-cache /nix/store:" $t
+
+t=`$srcdir/fakechroot.sh $testtree /bin/test-symlink-cache /tmp link 2>&1`
+test "$t" = "target-a 8 target-bb 9 target-bb gone same same" || not
+ok "fakechroot symlink-cache /tmp:" $t
+
+cleanup
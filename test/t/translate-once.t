@@ -0,0 +1,28 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+# The wrappers which were called, with their calls and translated calls
+stats () {
+    rm -f $stats
+    $srcdir/fakechroot.sh $testtree /usr/bin/env FAKECHROOT_STATS=$stats "$@" > /dev/null 2>&1
+    sed 's/"\([a-z_0-9]*\)":{"calls":\([0-9]*\),"translated":\([0-9]*\)/@\1 \2 \3@/g' $stats |
+        tr '@' '\n' | grep '^[a-z_0-9]* [0-9]* [0-9]*$' | sort | tr '\n' ' '
+}
+
+stats=`pwd`/$testtree/stats.json
+
+ln -s /CHROOT $testtree/symlink
+
+t=`stats /bin/test-lstat /symlink`
+test "$t" = "lstat 1 1 readlink 1 1 " || not
+ok "fakechroot lstat and readlink translate once:" $t
+
+t=`stats /bin/test-realpath /symlink`
+test "$t" = "realpath 1 0 " || not
+ok "fakechroot realpath walks without translation:" $t
+
+cleanup
@@ -0,0 +1,22 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+for chroot in chroot fakechroot; do
+
+    if [ $chroot = "chroot" ] && ! is_root; then
+        skip $(( $tap_plan / 2 )) "not root"
+    else
+
+        t=`$srcdir/$chroot.sh $testtree /bin/test-vfork-chdir /tmp 2>&1`
+        test "$t" = "/" || not
+        ok "$chroot vfork child's chdir leaves the parent in" $t
+
+    fi
+
+done
+
+cleanup
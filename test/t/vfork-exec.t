@@ -0,0 +1,22 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+for chroot in chroot fakechroot; do
+
+    if [ $chroot = "chroot" ] && ! is_root; then
+        skip $(( $tap_plan / 2 )) "not root"
+    else
+
+        t=`$srcdir/$chroot.sh $testtree /bin/test-vfork-exec 20 /bin/test-hello 2>&1 | grep -v Hello`
+        test "$t" = "ok" || not
+        ok "$chroot vfork children which called execve keep the stack use" $t
+
+    fi
+
+done
+
+cleanup
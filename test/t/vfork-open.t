@@ -0,0 +1,26 @@
+#!/bin/sh
+
+srcdir=${srcdir:-.}
+. $srcdir/common.inc.sh
+
+prepare 2
+
+for chroot in chroot fakechroot; do
+
+    if [ $chroot = "chroot" ] && ! is_root; then
+        skip $(( $tap_plan / 2 )) "not root"
+    else
+
+        mkdir -p $testtree/$chroot-vfork-open-a $testtree/$chroot-vfork-open-b
+        echo a > $testtree/$chroot-vfork-open-a/file
+        echo b > $testtree/$chroot-vfork-open-b/file
+
+        t=`echo $($srcdir/$chroot.sh $testtree /bin/test-vfork-open /$chroot-vfork-open-a /$chroot-vfork-open-b file 2>&1)`
+        test "$t" = "a a" || not
+        ok "$chroot vfork child's relative open leaves the parent with" $t
+
+    fi
+
+done
+
+cleanup